@@ -5,6 +5,7 @@
  */
 
 #include "eeprom24.h"
+#include "eeprom24_wear.h"
 #include "custom_assert.h"
 
 
@@ -14,23 +15,44 @@
  */
 bool Eeprom24::init()
 {
-	auto retval = HAL_I2C_IsDeviceReady(m_i2c, m_i2c_address << 1, 2, 100);
+	auto retval = probe(2, 100);
 	return (retval == HAL_OK);
 }
 
 
 /** After a write operation, the memory enters an internal lock-up state, during which it doesn't respond on the I2C bus.
  *  This function is used to check whether the memory is ready for new commands. Read operations don't start lock-up state.
+ *  While a write cycle is pending, the bus is not probed until the learned write cycle time has (almost) elapsed, and
+ *  the probe results are used to refine the write cycle estimate.
  *
  * @return				True is memory is ready to accept new commands.
  */
 bool Eeprom24::isReady(void) const
 {
-	return (HAL_I2C_IsDeviceReady(m_i2c, m_i2c_address << 1, 1, 100) == HAL_OK);
+	if (getTimeUntilReady() > 0)
+		return false;
+
+	bool ready = (probe(1, 100) == HAL_OK);
+
+	if (m_writePending)
+	{
+		uint32_t now = EEPROM24_GET_TIME_US();
+		if (ready)
+			finishWriteCycle(now);
+		else
+		{
+			m_writeBusySeen = true;
+			m_writeLastBusy = now;
+		}
+	}
+
+	return ready;
 }
 
 
-/** Polling function with timeout, used to wait until EEPROM is ready to accept new commands after write
+/** Polling function with timeout, used to wait until EEPROM is ready to accept new commands after write.
+ *  The first probe is scheduled from the learned write cycle time, so the bus stays free for most of the cycle. With a
+ *  shared bus, transfers of other devices are run in the meantime and the poll rate adapts to bus occupancy.
  *
  * @param timeout		Timeout in ms.
  * @return				True if device became ready before timeout.
@@ -38,9 +60,14 @@ bool Eeprom24::isReady(void) const
 bool Eeprom24::waitForReady(uint32_t timeout) const
 {
 	uint32_t start = HAL_GetTick();
+
+	uint32_t wait = getTimeUntilReady();
+	if (wait > 0)
+		pollDelay(wait);
+
 	while (!isReady())
 	{
-		HAL_Delay(1);
+		pollDelay(m_bus ? m_bus->getPollInterval() : 1000);
 
 		if (HAL_GetTick() - start > timeout)
 			return false;
@@ -50,6 +77,358 @@ bool Eeprom24::waitForReady(uint32_t timeout) const
 }
 
 
+/** Fastest possible ready polling: no delays between probes, and the timeout has us resolution. Meant for
+ *  time-critical paths such as an emergency flush, where bus occupancy doesn't matter anymore.
+ *
+ * @param timeout		Timeout in us.
+ * @return				True if device became ready before timeout.
+ */
+bool Eeprom24::spinForReady(uint32_t timeout) const
+{
+	uint32_t start = EEPROM24_GET_TIME_US();
+	while (!isReady())
+	{
+		if (EEPROM24_GET_TIME_US() - start > timeout)
+			return false;
+	}
+
+	return true;
+}
+
+
+/** Waits between ready probes; on a shared bus, the time is given to other devices.
+ *
+ * @param time			Time to wait in us.
+ */
+void Eeprom24::pollDelay(uint32_t time) const
+{
+	if (m_bus)
+		m_bus->yield(time);
+	else
+		EEPROM24_DELAY_US(time);
+}
+
+
+/** Returns how long it makes no sense to probe the memory, based on the learned write cycle time. Use it to arm a timer
+ *  and call isReady() from its callback instead of polling.
+ *
+ * @return				Time in us until the first ready probe is due; 0 if the memory should be probed now.
+ */
+uint32_t Eeprom24::getTimeUntilReady(void) const
+{
+	if (!m_writePending || m_writeBusySeen)
+		return 0;
+
+	//the first probe goes early by more than the timebase resolution, so that the estimate can converge downwards
+	uint32_t estimate = m_writeStats[m_writeBucket].estimate;
+	uint32_t margin = estimate / 8 + EEPROM24_TIME_RESOLUTION_US;
+	uint32_t firstProbe = (estimate > margin) ? (estimate - margin) : 0;
+	uint32_t elapsed = EEPROM24_GET_TIME_US() - m_writeStart;
+	if (elapsed >= firstProbe)
+		return 0;
+
+	//rounded down to whole timebase units, so that a coarse delay never pushes the first probe past the estimate
+	return (firstProbe - elapsed) / EEPROM24_TIME_RESOLUTION_US * EEPROM24_TIME_RESOLUTION_US;
+}
+
+
+/** Pessimistic duration of a complete write of the given size, i.e. the transfer plus the write cycle. The longest
+ *  observed cycle is used once there is one, as the estimate is meant for deadline planning.
+ *
+ * @param length		Number of bytes written.
+ * @return				Cost in us.
+ */
+uint32_t Eeprom24::getWriteCost(uint16_t length) const
+{
+	const WriteCycleStats& stats = getWriteCycleStats(length);
+	uint32_t cycle = (stats.count > 0 && stats.max > stats.estimate) ? stats.max : stats.estimate;
+	return (length + 3) * EEPROM24_BYTE_TIME_US + cycle;
+}
+
+
+/** Forgets all learned write cycle durations, estimates fall back to EEPROM24_TWR_MAX_US.
+ *
+ */
+void Eeprom24::resetWriteCycleStats(void)
+{
+	for (auto& stats : m_writeStats)
+		stats = {EEPROM24_TWR_MAX_US, UINT32_MAX, 0, 0};
+}
+
+
+/** Write cycle duration depends on the amount of data written, so statistics are kept separately per write size.
+ *
+ * @param length		Number of bytes written.
+ * @return				Index into m_writeStats.
+ */
+uint8_t Eeprom24::getWriteCycleBucket(uint16_t length) const
+{
+	if (length <= 1)
+		return 0;
+	else if (length <= m_pageSizeInBytes / 4)
+		return 1;
+	else if (length <= m_pageSizeInBytes / 2)
+		return 2;
+	else
+		return 3;
+}
+
+
+/** Called after every successful write transfer; marks the start of the memory's write cycle and counts the page
+ *  write if wear tracking is enabled.
+ *
+ * @param address		Memory address the write started at.
+ * @param length		Number of data bytes written.
+ */
+void Eeprom24::startWriteCycle(uint32_t address, uint16_t length)
+{
+	if (m_wear)
+		m_wear->onWrite(address);
+
+	m_writeBucket = getWriteCycleBucket(length);
+	m_writeStart = EEPROM24_GET_TIME_US();
+	m_writeBusySeen = false;
+	m_writePending = true;
+}
+
+
+/** Called when the memory first acknowledges after a write; turns the probe results into a write cycle sample.
+ *
+ * @param now			Time of the successful probe in us.
+ */
+void Eeprom24::finishWriteCycle(uint32_t now) const
+{
+	m_writePending = false;
+	WriteCycleStats& stats = m_writeStats[m_writeBucket];
+
+	uint32_t sample;
+	if (m_writeBusySeen)
+	{
+		//the cycle ended somewhere between the last busy probe and now; a stale busy probe tells us nothing
+		if (now - m_writeLastBusy > WRITE_CYCLE_SLACK_US)
+			return;
+		sample = (m_writeLastBusy - m_writeStart) + (now - m_writeLastBusy) / 2;
+	}
+	else
+	{
+		//ready on the first probe is only an upper bound, and only useful if the probe came before the estimate
+		sample = now - m_writeStart;
+		if (sample > stats.estimate)
+			return;
+	}
+
+	if (sample > EEPROM24_TWR_MAX_US)
+		sample = EEPROM24_TWR_MAX_US;
+
+	stats.count++;
+	if (sample < stats.min)
+		stats.min = sample;
+	if (sample > stats.max)
+		stats.max = sample;
+
+	if (stats.count == 1)
+		stats.estimate = sample;
+	else
+		stats.estimate = (int32_t)stats.estimate + ((int32_t)sample - (int32_t)stats.estimate) / 8;
+}
+
+
+/** Writes any amount of data, split into page writes along page boundaries. Waits for the previous write cycle to
+ *  finish before each page, but not after the last one.
+ *
+ * @param address		Address to start writing at.
+ * @param data			Pointer to an array with data to be written.
+ * @param length		How many bytes to write.
+ * @return				True if all pages were written successfully.
+ */
+bool Eeprom24::write(uint32_t address, const uint8_t* data, uint32_t length)
+{
+	if (address + length > m_sizeInBytes)
+		return false;
+
+	while (length > 0)
+	{
+		uint32_t chunk = m_pageSizeInBytes - (address % m_pageSizeInBytes);
+		if (chunk > length)
+			chunk = length;
+
+		if (m_writePending && !waitForReady())
+			return false;
+		if (!writePage(address, data, chunk))
+			return false;
+
+		address += chunk;
+		data += chunk;
+		length -= chunk;
+	}
+
+	return true;
+}
+
+
+/** Reads any amount of data, waiting for a pending write cycle first.
+ *
+ * @param address		Address to start reading at.
+ * @param data			Pointer to an array in which data will be stored.
+ * @param length		How many bytes to read.
+ * @return				True if read was successful.
+ */
+bool Eeprom24::read(uint32_t address, uint8_t* data, uint32_t length)
+{
+	if (address + length > m_sizeInBytes)
+		return false;
+
+	if (m_writePending && !waitForReady())
+		return false;
+
+	//sequential reads aren't limited by pages, only by the HAL's 16-bit length
+	while (length > 0)
+	{
+		uint32_t chunk = (length > 0x8000) ? 0x8000 : length;
+
+		if (!readPage(address, data, chunk))
+			return false;
+
+		address += chunk;
+		data += chunk;
+		length -= chunk;
+	}
+
+	return true;
+}
+
+
+/** Streams a region to a sink in chunks, through a double buffer: while the sink consumes one chunk, the next one is
+ *  already being received, so RAM use is two chunks regardless of the region size. The address is sent once and the
+ *  following chunks are current-address reads continuing where the previous one stopped.
+ *
+ *  Overlapping needs the I2C interrupts (EEPROM24_I2C_IT); without them, each chunk is read with a blocking read
+ *  before it is passed to the sink. The bus is held for the whole export; the sink must not access devices on the
+ *  same bus.
+ *
+ * @param address		Address to start reading at.
+ * @param length		How many bytes to export.
+ * @param buffer		Array of 2 * chunkSize bytes.
+ * @param chunkSize		Size of the chunks passed to the sink, e.g. the page size.
+ * @param sink			Called with each chunk, in order; chunks end at 256 B block boundaries of 1 byte addressed
+ * 						memories, so they may be shorter than chunkSize.
+ * @param context		Passed to the sink.
+ * @return				True if the whole region was read and accepted by the sink.
+ */
+bool Eeprom24::exportTo(uint32_t address, uint32_t length, uint8_t* buffer, uint16_t chunkSize, Sink sink, void* context)
+{
+	if (address + length > m_sizeInBytes || chunkSize == 0)
+		return false;
+
+	if (m_writePending && !waitForReady())
+		return false;
+
+	Eeprom24Bus::Transaction transaction(m_bus, &m_busClient);
+
+	if (length == 0)
+		return true;
+	if (!setReadAddress(address))
+		return false;
+
+	uint8_t* chunks[2] = {buffer, buffer + chunkSize};
+	uint8_t current = 0;
+	uint16_t filled = getExportChunk(address, length, chunkSize);
+
+#if EEPROM24_I2C_IT
+	if (startReceive(getDeviceAddress(address), chunks[current], filled) != HAL_OK ||
+		finishReceive(getDeviceAddress(address)) != HAL_OK)
+		return false;
+
+	while (true)
+	{
+		address += filled;
+		length -= filled;
+		uint16_t next = getExportChunk(address, length, chunkSize);
+
+		//the address is sent again in a new block, see getExportChunk()
+		if (next > 0 && !hasWideAddress() && address % 256 == 0 && !setReadAddress(address))
+			return false;
+		if (next > 0 && startReceive(getDeviceAddress(address), chunks[current ^ 1], next) != HAL_OK)
+			return false;
+
+		bool accepted = sink(chunks[current], filled, context);
+		if (next == 0)
+			return accepted;
+
+		//the receive has to finish even if the sink gave up, the buffer must not be left to the interrupt
+		if (finishReceive(getDeviceAddress(address)) != HAL_OK || !accepted)
+			return false;
+
+		current ^= 1;
+		filled = next;
+	}
+#else
+	(void)current;
+	while (length > 0)
+	{
+		if (!hasWideAddress() && address % 256 == 0 && !setReadAddress(address))
+			return false;
+		if (receive(getDeviceAddress(address), chunks[0], filled) != HAL_OK || !sink(chunks[0], filled, context))
+			return false;
+
+		address += filled;
+		length -= filled;
+		filled = getExportChunk(address, length, chunkSize);
+	}
+	return true;
+#endif
+}
+
+
+/** Size of the next export chunk. On 1 byte addressed memories (24x04 to 24x16), the block bits are part of the
+ *  device address; rather than relying on the internal address counter of the part to carry into the next block of a
+ *  current-address read, chunks end at block boundaries and the address is set again for the new block.
+ *
+ * @param address		Address of the chunk.
+ * @param length		Bytes left to export.
+ * @param chunkSize		Largest chunk.
+ * @return				Size of the chunk, 0 at the end of the export.
+ */
+uint16_t Eeprom24::getExportChunk(uint32_t address, uint32_t length, uint16_t chunkSize) const
+{
+	uint32_t chunk = (length > chunkSize) ? chunkSize : length;
+	if (!hasWideAddress() && chunk > 256 - address % 256)
+		chunk = 256 - address % 256;
+	return chunk;
+}
+
+
+/** Largest size not above the given one that divides the page size, so that blocks of it aligned to their own size
+ *  never straddle a page boundary; used for cache lines.
+ *
+ * @param size			Requested size in bytes.
+ * @return				Size to use.
+ */
+uint16_t Eeprom24::getPageAlignedSize(uint16_t size) const
+{
+	if (size > m_pageSizeInBytes)
+		size = m_pageSizeInBytes;
+	while (size > 1 && m_pageSizeInBytes % size != 0)
+		size--;
+	return size;
+}
+
+
+/** Sets the memory's address pointer for the following current-address reads.
+ *
+ * @param address		Address to read from next.
+ * @return				True if the memory acknowledged.
+ */
+bool Eeprom24::setReadAddress(uint16_t address)
+{
+	uint8_t tmp[2] = {(uint8_t)(address >> 8), (uint8_t)(address & 0xFF)};
+
+	if (hasWideAddress())
+		return transmit(m_i2c_address, tmp, sizeof(tmp)) == HAL_OK;
+	return transmit(getDeviceAddress(address), &tmp[1], 1) == HAL_OK;
+}
+
+
 /** Writes a byte to the EEPROM. Version for larger memories with 2 byte addresses.
  *
  * @param devAddress	EEPROM's I2C address, managed internally.
@@ -61,8 +440,12 @@ bool Eeprom24::waitForReady(uint32_t timeout) const
  */
 bool Eeprom24::writeByte_internal16(uint8_t devAddress, uint16_t byteAddress, uint8_t data)
 {
+	Eeprom24Bus::Transaction transaction(m_bus, &m_busClient);
+
 	uint8_t tmp[3] = {(uint8_t)(byteAddress >> 8), (uint8_t)(byteAddress & 0xFF), data};
-	auto retval = HAL_I2C_Master_Transmit(m_i2c, devAddress << 1, tmp, sizeof(tmp), EEPROM24_I2C_TIMEOUT);
+	auto retval = transmit(devAddress, tmp, sizeof(tmp), EEPROM24_I2C_TIMEOUT);
+	if (retval == HAL_OK)
+		startWriteCycle(byteAddress, 1);
 	return (retval == HAL_OK);
 }
 
@@ -78,8 +461,12 @@ bool Eeprom24::writeByte_internal16(uint8_t devAddress, uint16_t byteAddress, ui
  */
 bool Eeprom24::writeByte_internal8(uint8_t devAddress, uint8_t byteAddress, uint8_t data)
 {
+	Eeprom24Bus::Transaction transaction(m_bus, &m_busClient);
+
 	uint8_t tmp[2] = {byteAddress, data};
-	auto retval = HAL_I2C_Master_Transmit(m_i2c, devAddress << 1, tmp, sizeof(tmp), EEPROM24_I2C_TIMEOUT);
+	auto retval = transmit(devAddress, tmp, sizeof(tmp), EEPROM24_I2C_TIMEOUT);
+	if (retval == HAL_OK)
+		startWriteCycle(((devAddress & 0b11) << 8) | byteAddress, 1);
 	return (retval == HAL_OK);
 }
 
@@ -92,11 +479,13 @@ bool Eeprom24::writeByte_internal8(uint8_t devAddress, uint8_t byteAddress, uint
  */
 uint8_t Eeprom24::readByte_internal16(uint8_t devAddress, uint16_t byteAddress)
 {
+	Eeprom24Bus::Transaction transaction(m_bus, &m_busClient);
+
 	uint8_t tmp[2] = {(uint8_t)(byteAddress >> 8), (uint8_t)(byteAddress & 0xFF)};
-	HAL_I2C_Master_Transmit(m_i2c, devAddress << 1, tmp, sizeof(tmp), 25);
+	transmit(devAddress, tmp, sizeof(tmp), 25);
 
 	uint8_t retval = 0;
-	HAL_I2C_Master_Receive(m_i2c, devAddress << 1, &retval, 1, EEPROM24_I2C_TIMEOUT);
+	receive(devAddress, &retval, 1, EEPROM24_I2C_TIMEOUT);
 	return retval;
 }
 
@@ -109,10 +498,12 @@ uint8_t Eeprom24::readByte_internal16(uint8_t devAddress, uint16_t byteAddress)
  */
 uint8_t Eeprom24::readByte_internal8(uint8_t devAddress, uint8_t byteAddress)
 {
-	HAL_I2C_Master_Transmit(m_i2c, devAddress << 1, &byteAddress, 1, 25);
+	Eeprom24Bus::Transaction transaction(m_bus, &m_busClient);
+
+	transmit(devAddress, &byteAddress, 1, 25);
 
 	uint8_t retval = 0;
-	HAL_I2C_Master_Receive(m_i2c, devAddress << 1, &retval, 1, EEPROM24_I2C_TIMEOUT);
+	receive(devAddress, &retval, 1, EEPROM24_I2C_TIMEOUT);
 	return retval;
 }
 
@@ -128,8 +519,10 @@ uint8_t Eeprom24::readByte_internal8(uint8_t devAddress, uint8_t byteAddress)
  *
  * @note After writing, it takes the memory some time to save the data; poll using waitForReady.
  */
-bool Eeprom24::writePage_internal16(uint8_t devAddress, uint16_t byteAddress, uint8_t* data, uint16_t length)
+bool Eeprom24::writePage_internal16(uint8_t devAddress, uint16_t byteAddress, const uint8_t* data, uint16_t length)
 {
+	Eeprom24Bus::Transaction transaction(m_bus, &m_busClient);
+
 	uint8_t tmp[m_pageSizeInBytes + 2];
 	tmp[0] = byteAddress >> 8;
 	tmp[1] = byteAddress;
@@ -137,7 +530,9 @@ bool Eeprom24::writePage_internal16(uint8_t devAddress, uint16_t byteAddress, ui
 	for (uint16_t i = 0; i < length; i++)
 		tmp[i + 2] = data[i];
 
-	auto retval = HAL_I2C_Master_Transmit(m_i2c, devAddress << 1, tmp, length + 2, EEPROM24_I2C_TIMEOUT);
+	auto retval = transmit(devAddress, tmp, length + 2, EEPROM24_I2C_TIMEOUT);
+	if (retval == HAL_OK)
+		startWriteCycle(byteAddress, length);
 	return (retval == HAL_OK);
 }
 
@@ -153,15 +548,19 @@ bool Eeprom24::writePage_internal16(uint8_t devAddress, uint16_t byteAddress, ui
  *
  * @note After writing, it takes the memory some time to save the data; poll using waitForReady.
  */
-bool Eeprom24::writePage_internal8(uint8_t devAddress, uint8_t byteAddress, uint8_t* data, uint16_t length)
+bool Eeprom24::writePage_internal8(uint8_t devAddress, uint8_t byteAddress, const uint8_t* data, uint16_t length)
 {
+	Eeprom24Bus::Transaction transaction(m_bus, &m_busClient);
+
 	uint8_t tmp[m_pageSizeInBytes + 1];
 	tmp[0] = byteAddress;
 
 	for (uint16_t i = 0; i < length; i++)
 		tmp[i + 1] = data[i];
 
-	auto retval = HAL_I2C_Master_Transmit(m_i2c, devAddress << 1, tmp, length + 1, EEPROM24_I2C_TIMEOUT);
+	auto retval = transmit(devAddress, tmp, length + 1, EEPROM24_I2C_TIMEOUT);
+	if (retval == HAL_OK)
+		startWriteCycle(((devAddress & 0b11) << 8) | byteAddress, length);
 	return (retval == HAL_OK);
 }
 
@@ -176,10 +575,12 @@ bool Eeprom24::writePage_internal8(uint8_t devAddress, uint8_t byteAddress, uint
  */
 bool Eeprom24::readPage_internal16(uint8_t devAddress, uint16_t byteAddress, uint8_t* data, uint16_t length)
 {
+	Eeprom24Bus::Transaction transaction(m_bus, &m_busClient);
+
 	uint8_t tmp[2] = {(uint8_t)(byteAddress >> 8), (uint8_t)(byteAddress & 0xFF)};
-	HAL_I2C_Master_Transmit(m_i2c, devAddress << 1, tmp, sizeof(tmp), EEPROM24_I2C_TIMEOUT);
+	transmit(devAddress, tmp, sizeof(tmp), EEPROM24_I2C_TIMEOUT);
 
-	auto retval = HAL_I2C_Master_Receive(m_i2c, devAddress << 1, data, length, EEPROM24_I2C_TIMEOUT);
+	auto retval = receive(devAddress, data, length, EEPROM24_I2C_TIMEOUT);
 	return (retval == HAL_OK);
 }
 
@@ -194,11 +595,86 @@ bool Eeprom24::readPage_internal16(uint8_t devAddress, uint16_t byteAddress, uin
  */
 bool Eeprom24::readPage_internal8(uint8_t devAddress, uint8_t byteAddress, uint8_t* data, uint16_t length)
 {
-	HAL_I2C_Master_Transmit(m_i2c, devAddress << 1, &byteAddress, sizeof(byteAddress), EEPROM24_I2C_TIMEOUT);
+	Eeprom24Bus::Transaction transaction(m_bus, &m_busClient);
+
+	transmit(devAddress, &byteAddress, sizeof(byteAddress), EEPROM24_I2C_TIMEOUT);
 
-	auto retval = HAL_I2C_Master_Receive(m_i2c, devAddress << 1, data, length, EEPROM24_I2C_TIMEOUT);
+	auto retval = receive(devAddress, data, length, EEPROM24_I2C_TIMEOUT);
 	return (retval == HAL_OK);
 }
 
 
+/** Transmits data to the EEPROM, either directly or through the shared bus; callers hold the bus transaction.
+ *
+ * @param devAddress	EEPROM's I2C address, managed internally.
+ * @param data			Pointer to data to transmit.
+ * @param length		Number of bytes to transmit.
+ * @param timeout		Timeout in ms.
+ * @return				Status returned by HAL.
+ */
+HAL_StatusTypeDef Eeprom24::transmit(uint8_t devAddress, uint8_t* data, uint16_t length, uint32_t timeout) const
+{
+	if (m_bus)
+		return m_bus->transmit(devAddress << 1, data, length, timeout);
+	return HAL_I2C_Master_Transmit(m_i2c, devAddress << 1, data, length, timeout);
+}
+
+
+/** Receives data from the EEPROM, either directly or through the shared bus; callers hold the bus transaction.
+ *
+ * @param devAddress	EEPROM's I2C address, managed internally.
+ * @param data			Pointer to an array in which data will be stored.
+ * @param length		Number of bytes to receive.
+ * @param timeout		Timeout in ms.
+ * @return				Status returned by HAL.
+ */
+HAL_StatusTypeDef Eeprom24::receive(uint8_t devAddress, uint8_t* data, uint16_t length, uint32_t timeout) const
+{
+	if (m_bus)
+		return m_bus->receive(devAddress << 1, data, length, timeout);
+	return HAL_I2C_Master_Receive(m_i2c, devAddress << 1, data, length, timeout);
+}
+
+
+/** Starts an interrupt driven receive, either directly or through the shared bus; callers hold the bus transaction.
+ *
+ * @param devAddress	EEPROM's I2C address, managed internally.
+ * @param data			Pointer to an array in which data will be stored; must stay valid until finishReceive().
+ * @param length		Number of bytes to receive.
+ * @return				Status returned by HAL.
+ */
+HAL_StatusTypeDef Eeprom24::startReceive(uint8_t devAddress, uint8_t* data, uint16_t length) const
+{
+	if (m_bus)
+		return m_bus->startReceive(devAddress << 1, data, length);
+	return HAL_I2C_Master_Receive_IT(m_i2c, devAddress << 1, data, length);
+}
+
+
+/** Waits for a receive started by startReceive().
+ *
+ * @param devAddress	EEPROM's I2C address, managed internally.
+ * @param timeout		Timeout in ms.
+ * @return				Status of the finished transfer.
+ */
+HAL_StatusTypeDef Eeprom24::finishReceive(uint8_t devAddress, uint32_t timeout) const
+{
+	if (m_bus)
+		return m_bus->finishTransfer(devAddress << 1, timeout);
+	return Eeprom24Bus::pollTransfer(m_i2c, devAddress << 1, timeout);
+}
 
+
+/** Probes the EEPROM's address, either directly or through the shared bus.
+ *
+ * @param trials		Number of probe attempts.
+ * @param timeout		Timeout in ms.
+ * @return				Status returned by HAL.
+ */
+HAL_StatusTypeDef Eeprom24::probe(uint32_t trials, uint32_t timeout) const
+{
+	Eeprom24Bus::Transaction transaction(m_bus, &m_busClient);
+	if (m_bus)
+		return m_bus->isDeviceReady(m_i2c_address << 1, trials, timeout);
+	return HAL_I2C_IsDeviceReady(m_i2c, m_i2c_address << 1, trials, timeout);
+}
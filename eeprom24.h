@@ -8,10 +8,10 @@
 #define EEPROM24_H_
 
 #include "hal_inc.h"
+#include "eeprom24_config.h"
+#include "eeprom24_bus.h"
 
-#ifndef EEPROM24_I2C_TIMEOUT
-#define EEPROM24_I2C_TIMEOUT		25
-#endif
+class Eeprom24Wear;
 
 class Eeprom24
 {
@@ -20,14 +20,68 @@ public:
 		m_i2c(i2c), m_i2c_address(address), m_sizeInBytes(size), m_pageSizeInBytes(page) {};
 
 	bool init();
+	//needed with an RTOS (EEPROM24_OS): only transfers through the bus are locked and interrupt driven
+	void setBus(Eeprom24Bus* bus) {m_bus = bus; if (bus) bus->attach(&m_busClient);};
+	const Eeprom24Bus::Client& getBusClient(void) const {return m_busClient;};
+	void setWearTracker(Eeprom24Wear* wear) {m_wear = wear;};
 
 	bool isReady(void) const;
 	bool waitForReady(uint32_t timeout = EEPROM24_I2C_TIMEOUT) const;
+	bool spinForReady(uint32_t timeout) const;
 
+	//capacity, not the last address: 65536 for a 24x512, so that address + length <= size bounds a whole-chip access
 	uint32_t getSizeInBytes(void) const {return m_sizeInBytes;};
 	uint16_t getPageSizeInBytes(void) const {return m_pageSizeInBytes;};
+	uint16_t getPageAlignedSize(uint16_t size) const;
+
+	bool writeByte(uint16_t address, uint8_t data)
+	{
+		return hasWideAddress() ? writeByte_internal16(m_i2c_address, address, data) :
+			writeByte_internal8(getDeviceAddress(address), address, data);
+	};
+	uint8_t readByte(uint16_t address)
+	{
+		return hasWideAddress() ? readByte_internal16(m_i2c_address, address) :
+			readByte_internal8(getDeviceAddress(address), address);
+	};
+
+	bool writePage(uint16_t address, const uint8_t* data, uint16_t length)
+	{
+		return hasWideAddress() ? writePage_internal16(m_i2c_address, address, data, length) :
+			writePage_internal8(getDeviceAddress(address), address, data, length);
+	};
+	bool readPage(uint16_t address, uint8_t* data, uint16_t length)
+	{
+		return hasWideAddress() ? readPage_internal16(m_i2c_address, address, data, length) :
+			readPage_internal8(getDeviceAddress(address), address, data, length);
+	};
+
+	bool write(uint32_t address, const uint8_t* data, uint32_t length);
+	bool read(uint32_t address, uint8_t* data, uint32_t length);
+
+	/** Receives exported data; returning false stops the export. */
+	typedef bool (*Sink)(const uint8_t* data, uint16_t length, void* context);
+	bool exportTo(uint32_t address, uint32_t length, uint8_t* buffer, uint16_t chunkSize, Sink sink, void* context);
+
+	/** Running statistics of measured write cycle durations, all times in us. */
+	struct WriteCycleStats
+	{
+		uint32_t estimate;
+		uint32_t min;
+		uint32_t max;
+		uint32_t count;
+	};
+
+	bool isWritePending(void) const {return m_writePending;};
+	uint32_t getTimeUntilReady(void) const;
+	uint32_t getWriteCycleEstimate(uint16_t length) const {return m_writeStats[getWriteCycleBucket(length)].estimate;};
+	const WriteCycleStats& getWriteCycleStats(uint16_t length) const {return m_writeStats[getWriteCycleBucket(length)];};
+	uint32_t getWriteCost(uint16_t length) const;
+	void resetWriteCycleStats(void);
 
 	static constexpr uint8_t DEFAULT_ADDRESS = 0b1010000;
+	static constexpr uint8_t WRITE_CYCLE_BUCKETS = 4;
+	static constexpr uint32_t WRITE_CYCLE_SLACK_US = 2000;
 
 protected:
 	bool writeByte_internal16(uint8_t devAddress, uint16_t byteAddress, uint8_t data);
@@ -35,15 +89,49 @@ protected:
 	uint8_t readByte_internal16(uint8_t devAddress, uint16_t byteAddress);
 	uint8_t readByte_internal8(uint8_t devAddress, uint8_t byteAddress);
 
-	bool writePage_internal16(uint8_t devAddress, uint16_t byteAddress, uint8_t* data, uint16_t length);
-	bool writePage_internal8(uint8_t devAddress, uint8_t byteAddress, uint8_t* data, uint16_t length);
+	bool writePage_internal16(uint8_t devAddress, uint16_t byteAddress, const uint8_t* data, uint16_t length);
+	bool writePage_internal8(uint8_t devAddress, uint8_t byteAddress, const uint8_t* data, uint16_t length);
 	bool readPage_internal16(uint8_t devAddress, uint16_t byteAddress, uint8_t* data, uint16_t length);
 	bool readPage_internal8(uint8_t devAddress, uint8_t byteAddress, uint8_t* data, uint16_t length);
 
+	HAL_StatusTypeDef transmit(uint8_t devAddress, uint8_t* data, uint16_t length, uint32_t timeout = EEPROM24_I2C_TIMEOUT) const;
+	HAL_StatusTypeDef receive(uint8_t devAddress, uint8_t* data, uint16_t length, uint32_t timeout = EEPROM24_I2C_TIMEOUT) const;
+	HAL_StatusTypeDef probe(uint32_t trials, uint32_t timeout) const;
+	HAL_StatusTypeDef startReceive(uint8_t devAddress, uint8_t* data, uint16_t length) const;
+	HAL_StatusTypeDef finishReceive(uint8_t devAddress, uint32_t timeout = EEPROM24_I2C_TIMEOUT) const;
+	uint16_t getExportChunk(uint32_t address, uint32_t length, uint16_t chunkSize) const;
+
+	bool setReadAddress(uint16_t address);
+
+	/** Memories up to 2 kB (24x16) take one address byte and the upper address bits from the I2C address. */
+	bool hasWideAddress(void) const {return m_sizeInBytes > 2048;};
+	uint8_t getDeviceAddress(uint16_t address) const
+	{
+		return hasWideAddress() ? m_i2c_address : m_i2c_address | ((address >> 8) & ((m_sizeInBytes >> 8) - 1));
+	};
+	void pollDelay(uint32_t time) const;
+
+	uint8_t getWriteCycleBucket(uint16_t length) const;
+	void startWriteCycle(uint32_t address, uint16_t length);
+	void finishWriteCycle(uint32_t now) const;
+
 	I2C_HandleTypeDef* const m_i2c;
 	const uint8_t m_i2c_address;
 	const uint32_t m_sizeInBytes;
 	const uint16_t m_pageSizeInBytes;
+	Eeprom24Bus* m_bus = nullptr;
+	mutable Eeprom24Bus::Client m_busClient;
+	Eeprom24Wear* m_wear = nullptr;
+
+	//write cycle calibration; updated from isReady(), hence mutable
+	mutable WriteCycleStats m_writeStats[WRITE_CYCLE_BUCKETS] = {
+		{EEPROM24_TWR_MAX_US, UINT32_MAX, 0, 0}, {EEPROM24_TWR_MAX_US, UINT32_MAX, 0, 0},
+		{EEPROM24_TWR_MAX_US, UINT32_MAX, 0, 0}, {EEPROM24_TWR_MAX_US, UINT32_MAX, 0, 0}};
+	mutable bool m_writePending = false;
+	mutable bool m_writeBusySeen = false;
+	uint8_t m_writeBucket = 0;
+	uint32_t m_writeStart = 0;
+	mutable uint32_t m_writeLastBusy = 0;
 };
 
 
@@ -54,27 +142,9 @@ class Eeprom24_512: public Eeprom24
 {
 public:
 	Eeprom24_512(I2C_HandleTypeDef* i2c, uint8_t address = DEFAULT_ADDRESS):
-		Eeprom24(i2c, address, 65535, 128) {};
+		Eeprom24(i2c, address, 65536, 128) {};
 	Eeprom24_512(I2C_HandleTypeDef* i2c, bool A0, bool A1, bool A2):
-		Eeprom24(i2c, DEFAULT_ADDRESS | (A0) | (A1 << 1) | (A2 << 2), 65535, 128) {};
-
-	bool writeByte(uint16_t address, uint8_t data)
-	{
-		return writeByte_internal16(m_i2c_address, address, data);
-	};
-	uint8_t readByte(uint16_t address)
-	{
-		return readByte_internal16(m_i2c_address, address);
-	};
-
-	bool writePage(uint16_t address, uint8_t* data, uint16_t length)
-	{
-		return writePage_internal16(m_i2c_address, address, data, length);
-	};
-	bool readPage(uint16_t address, uint8_t* data, uint16_t length)
-	{
-		return readPage_internal16(m_i2c_address, address, data, length);
-	};
+		Eeprom24(i2c, DEFAULT_ADDRESS | (A0) | (A1 << 1) | (A2 << 2), 65536, 128) {};
 };
 
 
@@ -85,27 +155,9 @@ class Eeprom24_08: public Eeprom24
 {
 public:
 	Eeprom24_08(I2C_HandleTypeDef* i2c, uint8_t address = DEFAULT_ADDRESS):
-		Eeprom24(i2c, address, 1023, 16) {};
+		Eeprom24(i2c, address, 1024, 16) {};
 	Eeprom24_08(I2C_HandleTypeDef* i2c, bool A2):
-		Eeprom24(i2c, DEFAULT_ADDRESS | (A2 << 2), 1023, 16) {};
-
-	bool writeByte(uint16_t address, uint8_t data)
-	{
-		return writeByte_internal8(m_i2c_address | ((address >> 8) & 0b11), address, data);
-	};
-	uint8_t readByte(uint16_t address)
-	{
-		return readByte_internal8(m_i2c_address | ((address >> 8) & 0b11), address);
-	};
-
-	bool writePage(uint16_t address, uint8_t* data, uint16_t length)
-	{
-		return writePage_internal8(m_i2c_address | ((address >> 8) & 0b11), address, data, length);
-	};
-	bool readPage(uint16_t address, uint8_t* data, uint16_t length)
-	{
-		return readPage_internal8(m_i2c_address | ((address >> 8) & 0b11), address, data, length);
-	};
+		Eeprom24(i2c, DEFAULT_ADDRESS | (A2 << 2), 1024, 16) {};
 };
 
 #endif /* EEPROM24_H_ */
@@ -0,0 +1,414 @@
+/* eeprom24_blob.cpp
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "eeprom24_blob.h"
+
+
+Eeprom24BlobStore::Eeprom24BlobStore(Eeprom24& eeprom, uint32_t address, uint16_t pageCount, Entry* directory,
+	uint8_t entryCount, uint32_t* bitmap):
+	m_eeprom(eeprom), m_address(address), m_pageCount(pageCount),
+	m_pageSize((eeprom.getPageSizeInBytes() < EEPROM24_MAX_PAGE_SIZE) ? eeprom.getPageSizeInBytes() : EEPROM24_MAX_PAGE_SIZE),
+	m_directory(directory), m_entryCount(entryCount),
+	m_directoryPages((entryCount * 2 * sizeof(StoredEntry) + m_pageSize - 1) / m_pageSize), m_bitmap(bitmap)
+{
+}
+
+
+/** Loads the directory and rebuilds the bitmap of used pages by walking all blobs. Entries with a broken chain are
+ *  dropped from RAM, pages not referenced by any blob are free.
+ *
+ * @return				True if the directory could be read.
+ */
+bool Eeprom24BlobStore::mount(void)
+{
+	for (uint8_t id = 0; id < m_entryCount; id++)
+	{
+		if (!readEntry(id, &m_directory[id]))
+			return false;
+	}
+
+	memset(m_bitmap, 0, (m_pageCount + 31) / 32 * sizeof(uint32_t));
+	for (uint16_t page = m_pageCount; page % 32 != 0; page++)
+		setUsed(page);
+	for (uint16_t page = 0; page < m_directoryPages; page++)
+		setUsed(page);
+	m_freePages = m_pageCount - m_directoryPages;
+	m_allocationHint = 0;
+
+	uint16_t payload = getPayloadSize();
+	for (uint8_t id = 0; id < m_entryCount; id++)
+	{
+		Entry& entry = m_directory[id];
+		if (entry.size == 0xFFFFFFFF)
+			continue;
+
+		bool valid = (entry.pageCount == (entry.size + payload - 1) / payload);
+		uint16_t page = entry.firstPage;
+		uint16_t walked = 0;
+
+		for (; valid && walked < entry.pageCount; walked++)
+		{
+			if (page >= m_pageCount || isUsed(page))
+			{
+				valid = false;
+				break;
+			}
+
+			setUsed(page);
+			m_freePages--;
+			if (!readLink(page, &page))
+				return false;
+		}
+
+		if (!valid)
+		{
+			freeChain(entry.firstPage, walked);
+			entry.size = 0xFFFFFFFF;
+		}
+	}
+
+	return true;
+}
+
+
+/** Erases the directory; all pages become free.
+ *
+ * @return				True if write operation was successful.
+ */
+bool Eeprom24BlobStore::format(void)
+{
+	uint8_t blank[EEPROM24_MAX_PAGE_SIZE];
+	memset(blank, 0xFF, m_pageSize);
+
+	//a page at a time, so that the buffer doesn't grow with the directory
+	uint32_t end = m_address + m_entryCount * 2 * sizeof(StoredEntry);
+	for (uint32_t address = m_address; address < end; )
+	{
+		uint32_t chunk = m_pageSize - address % m_pageSize;
+		if (chunk > end - address)
+			chunk = end - address;
+		if (!m_eeprom.write(address, blank, chunk))
+			return false;
+		address += chunk;
+	}
+
+	return mount();
+}
+
+
+/** Deletes a blob; its pages are free once the directory entry is written.
+ *
+ * @param id			Blob id.
+ * @return				True if the blob existed and was deleted.
+ */
+bool Eeprom24BlobStore::remove(uint8_t id)
+{
+	if (!exists(id))
+		return false;
+
+	Entry old = m_directory[id];
+	Entry blank = {0xFFFFFFFF, NO_PAGE, 0xFFFF, old.sequence};
+	if (!writeEntry(id, blank))
+		return false;
+
+	freeChain(old.firstPage, old.pageCount);
+	return true;
+}
+
+
+/** Takes a free page, scanning the bitmap a word at a time from where the last allocation left off.
+ *
+ * @return				Page index, NO_PAGE if the store is full.
+ */
+uint16_t Eeprom24BlobStore::allocatePage(void)
+{
+	uint16_t words = (m_pageCount + 31) / 32;
+
+	for (uint16_t n = 0; n < words; n++)
+	{
+		uint16_t word = (m_allocationHint + n) % words;
+		if (m_bitmap[word] == 0xFFFFFFFF)
+			continue;
+
+		uint16_t page = word * 32 + __builtin_ctz(~m_bitmap[word]);
+		setUsed(page);
+		m_freePages--;
+		m_allocationHint = word;
+		return page;
+	}
+
+	return NO_PAGE;
+}
+
+
+void Eeprom24BlobStore::freePage(uint16_t page)
+{
+	if (page >= m_pageCount || !isUsed(page))
+		return;
+
+	m_bitmap[page / 32] &= ~(1UL << (page % 32));
+	m_freePages++;
+}
+
+
+/** Frees the pages of a chain in RAM; the links are read from the memory.
+ *
+ * @param page			First page of the chain.
+ * @param count			Number of pages to free.
+ */
+void Eeprom24BlobStore::freeChain(uint16_t page, uint16_t count)
+{
+	for (uint16_t i = 0; i < count && page < m_pageCount; i++)
+	{
+		uint16_t next = NO_PAGE;
+		if (i + 1 < count && !readLink(page, &next))
+			next = NO_PAGE;
+
+		freePage(page);
+		page = next;
+	}
+}
+
+
+bool Eeprom24BlobStore::readLink(uint16_t page, uint16_t* next)
+{
+	return m_eeprom.read(getPageAddress(page), reinterpret_cast<uint8_t*>(next), LINK_SIZE);
+}
+
+
+/** Reads both copies of an entry and takes the newer one that passes its CRC; without one, the entry is unused.
+ *
+ * @param id			Blob id.
+ * @param entry			Receives the entry.
+ * @return				True if read was successful.
+ */
+bool Eeprom24BlobStore::readEntry(uint8_t id, Entry* entry)
+{
+	StoredEntry copies[2];
+	if (!m_eeprom.read(getEntryAddress(id, 0), reinterpret_cast<uint8_t*>(copies), sizeof(copies)))
+		return false;
+
+	*entry = {0xFFFFFFFF, NO_PAGE, 0xFFFF, 0xFFFF};
+	bool found = false;
+
+	for (const StoredEntry& copy : copies)
+	{
+		if (eeprom24Crc16(reinterpret_cast<const uint8_t*>(&copy), offsetof(StoredEntry, crc)) != copy.crc)
+			continue;
+
+		if (!found || (int16_t)(copy.sequence - entry->sequence) > 0)
+			*entry = {copy.size, copy.firstPage, copy.pageCount, copy.sequence};
+		found = true;
+	}
+
+	return true;
+}
+
+
+/** Writes an entry into the copy that doesn't hold the current one, with the next sequence number.
+ *
+ * @param id			Blob id.
+ * @param entry			New entry; its sequence is ignored.
+ * @return				True if write operation was successful.
+ */
+bool Eeprom24BlobStore::writeEntry(uint8_t id, const Entry& entry)
+{
+	uint16_t sequence = m_directory[id].sequence + 1;
+	StoredEntry copy = {entry.size, entry.firstPage, entry.pageCount, sequence, 0};
+	copy.crc = eeprom24Crc16(reinterpret_cast<const uint8_t*>(&copy), offsetof(StoredEntry, crc));
+
+	if (!m_eeprom.write(getEntryAddress(id, sequence % 2), reinterpret_cast<const uint8_t*>(&copy), sizeof(copy)))
+		return false;
+
+	m_directory[id] = {entry.size, entry.firstPage, entry.pageCount, sequence};
+	return true;
+}
+
+
+/** Starts writing a new version of a blob.
+ *
+ * @param id			Blob id.
+ * @return				False if the id is out of range or the writer is already open.
+ */
+bool Eeprom24BlobStore::Writer::open(uint8_t id)
+{
+	if (id >= m_store.m_entryCount || m_open)
+		return false;
+
+	m_id = id;
+	m_open = true;
+	m_bufferCount = 0;
+	m_page = NO_PAGE;
+	m_firstPage = NO_PAGE;
+	m_pageCount = 0;
+	m_size = 0;
+	return true;
+}
+
+
+/** Appends data to the blob; a page is written once it is full and the blob continues past it.
+ *
+ * @param data			Pointer to data to write.
+ * @param length		Number of bytes.
+ * @return				False if the store is full or a write failed; abort() the writer then.
+ */
+bool Eeprom24BlobStore::Writer::write(const uint8_t* data, uint32_t length)
+{
+	if (!m_open)
+		return false;
+
+	uint16_t payload = m_store.getPayloadSize();
+
+	while (length > 0)
+	{
+		if (m_page == NO_PAGE || m_bufferCount == payload)
+		{
+			uint16_t next = m_store.allocatePage();
+			if (next == NO_PAGE)
+				return false;
+
+			if (m_page == NO_PAGE)
+				m_firstPage = next;
+			else if (!writePage(next))
+			{
+				m_store.freePage(next);
+				return false;
+			}
+
+			m_page = next;
+			m_pageCount++;
+			m_bufferCount = 0;
+		}
+
+		uint16_t chunk = payload - m_bufferCount;
+		if (chunk > length)
+			chunk = length;
+
+		memcpy(&m_buffer[LINK_SIZE + m_bufferCount], data, chunk);
+		m_bufferCount += chunk;
+		m_size += chunk;
+		data += chunk;
+		length -= chunk;
+	}
+
+	return true;
+}
+
+
+/** Writes the last page and commits the blob by writing its directory entry; the previous version is freed.
+ *
+ * @return				True if the blob was committed; otherwise the previous version remains.
+ */
+bool Eeprom24BlobStore::Writer::close(void)
+{
+	if (!m_open)
+		return false;
+
+	if (m_page != NO_PAGE && !writePage(NO_PAGE))
+	{
+		abort();
+		return false;
+	}
+
+	Entry old = m_store.m_directory[m_id];
+	Entry entry = {m_size, m_firstPage, m_pageCount, old.sequence};
+	if (!m_store.writeEntry(m_id, entry))
+	{
+		abort();
+		return false;
+	}
+
+	if (old.size != 0xFFFFFFFF)
+		m_store.freeChain(old.firstPage, old.pageCount);
+
+	m_open = false;
+	return true;
+}
+
+
+/** Drops the blob being written and frees its pages; the previous version remains.
+ *
+ */
+void Eeprom24BlobStore::Writer::abort(void)
+{
+	if (!m_open)
+		return;
+
+	//all pages but the current one have been written with their links
+	if (m_pageCount > 1)
+		m_store.freeChain(m_firstPage, m_pageCount - 1);
+	m_store.freePage(m_page);
+	m_open = false;
+}
+
+
+bool Eeprom24BlobStore::Writer::writePage(uint16_t next)
+{
+	memcpy(m_buffer, &next, LINK_SIZE);
+	return m_store.m_eeprom.write(m_store.getPageAddress(m_page), m_buffer, LINK_SIZE + m_bufferCount);
+}
+
+
+/** Opens a blob for reading from its start.
+ *
+ * @param id			Blob id.
+ * @return				False if there is no such blob.
+ */
+bool Eeprom24BlobStore::Reader::open(uint8_t id)
+{
+	if (!m_store.exists(id))
+		return false;
+
+	const Entry& entry = m_store.m_directory[id];
+	m_page = entry.firstPage;
+	m_offset = 0;
+	m_size = entry.size;
+	m_remaining = entry.size;
+	return true;
+}
+
+
+/** Reads the next part of the blob straight into the caller's array.
+ *
+ * @param data			Array receiving the data.
+ * @param length		Number of bytes wanted.
+ * @return				Number of bytes read; less than length at the end of the blob or on a read error.
+ */
+uint32_t Eeprom24BlobStore::Reader::read(uint8_t* data, uint32_t length)
+{
+	uint16_t payload = m_store.getPayloadSize();
+	uint32_t done = 0;
+
+	while (done < length && m_remaining > 0)
+	{
+		if (m_offset == payload)
+		{
+			if (!m_store.readLink(m_page, &m_page))
+				break;
+			m_offset = 0;
+		}
+
+		//a link can only be out of range if the memory changed since mount() checked the chain
+		if (m_page >= m_store.m_pageCount)
+			break;
+
+		uint32_t chunk = payload - m_offset;
+		if (chunk > length - done)
+			chunk = length - done;
+		if (chunk > m_remaining)
+			chunk = m_remaining;
+
+		if (!m_store.m_eeprom.read(m_store.getPageAddress(m_page) + LINK_SIZE + m_offset, data + done, chunk))
+			break;
+
+		m_offset += chunk;
+		m_remaining -= chunk;
+		done += chunk;
+	}
+
+	return done;
+}
@@ -0,0 +1,148 @@
+/* eeprom24_blob.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_BLOB_H_
+#define EEPROM24_BLOB_H_
+
+#include "eeprom24.h"
+#include "eeprom24_crc.h"
+
+/** Store of variable-size blobs (certificates, curves, descriptors) identified by small integer ids. The region starts
+ *  with a directory of fixed entries, followed by pages allocated one at a time; each page begins with the index of
+ *  the next page of its blob, so a blob is a chain of whole pages and every write is a single page write.
+ *
+ *  The directory and a bitmap of used pages are kept in RAM; both are rebuilt by mount(), which walks the chains.
+ *  Looking up a blob is an index into the directory, allocating a page a bit scan starting at the last allocation.
+ *  A blob is replaced atomically: the new chain is written first, then its directory entry, and only then the old
+ *  pages become free. Pages of an interrupted write are not referenced and are reclaimed by the next mount(). Each id
+ *  has two entry copies with a sequence number and a CRC, written alternately; mount() takes the newer valid one, so
+ *  an entry torn by a power loss leaves the previous version in place.
+ *
+ *  Use Eeprom24BlobStoreBuffer to get the storage.
+ */
+class Eeprom24BlobStore
+{
+public:
+	struct Entry
+	{
+		uint32_t size;			///< 0xFFFFFFFF for an unused entry
+		uint16_t firstPage;		///< NO_PAGE for an empty blob
+		uint16_t pageCount;
+		uint16_t sequence;		///< of the copy in the memory; the next write goes to the other copy
+	};
+
+	/** Streams a new version of a blob into the store; the old version stays readable until close(). */
+	class Writer
+	{
+	public:
+		Writer(Eeprom24BlobStore& store): m_store(store) {};
+
+		bool open(uint8_t id);
+		bool write(const uint8_t* data, uint32_t length);
+		bool close(void);
+		void abort(void);
+
+	protected:
+		bool writePage(uint16_t next);
+
+		Eeprom24BlobStore& m_store;
+		uint8_t m_id = 0;
+		bool m_open = false;
+
+		uint8_t m_buffer[EEPROM24_MAX_PAGE_SIZE];
+		uint16_t m_bufferCount = 0;
+		uint16_t m_page = NO_PAGE;
+		uint16_t m_firstPage = NO_PAGE;
+		uint16_t m_pageCount = 0;
+		uint32_t m_size = 0;
+	};
+
+	/** Streams a blob out of the store. */
+	class Reader
+	{
+	public:
+		Reader(Eeprom24BlobStore& store): m_store(store) {};
+
+		bool open(uint8_t id);
+		uint32_t read(uint8_t* data, uint32_t length);
+		uint32_t getSize(void) const {return m_size;};
+
+	protected:
+		Eeprom24BlobStore& m_store;
+		uint16_t m_page = NO_PAGE;
+		uint16_t m_offset = 0;
+		uint32_t m_size = 0;
+		uint32_t m_remaining = 0;
+	};
+
+	Eeprom24BlobStore(Eeprom24& eeprom, uint32_t address, uint16_t pageCount, Entry* directory, uint8_t entryCount,
+		uint32_t* bitmap);
+
+	bool mount(void);
+	bool format(void);
+	bool remove(uint8_t id);
+
+	bool exists(uint8_t id) const {return id < m_entryCount && m_directory[id].size != 0xFFFFFFFF;};
+	uint32_t getSize(uint8_t id) const {return exists(id) ? m_directory[id].size : 0;};
+	uint16_t getFreePages(void) const {return m_freePages;};
+	uint16_t getPayloadSize(void) const {return m_pageSize - LINK_SIZE;};
+
+	static constexpr uint16_t NO_PAGE = 0xFFFF;
+	static constexpr uint8_t LINK_SIZE = sizeof(uint16_t);
+
+protected:
+	uint16_t allocatePage(void);
+	void freePage(uint16_t page);
+	void freeChain(uint16_t page, uint16_t count);
+	bool isUsed(uint16_t page) const {return m_bitmap[page / 32] & (1UL << (page % 32));};
+	void setUsed(uint16_t page) {m_bitmap[page / 32] |= 1UL << (page % 32);};
+	bool readLink(uint16_t page, uint16_t* next);
+	bool readEntry(uint8_t id, Entry* entry);
+	bool writeEntry(uint8_t id, const Entry& entry);
+	uint32_t getPageAddress(uint16_t page) const {return m_address + (uint32_t)page * m_pageSize;};
+	uint32_t getEntryAddress(uint8_t id, uint8_t copy) const {return m_address + ((uint32_t)id * 2 + copy) * sizeof(StoredEntry);};
+
+	/** Entry copy in the memory. */
+	struct StoredEntry
+	{
+		uint32_t size;
+		uint16_t firstPage;
+		uint16_t pageCount;
+		uint16_t sequence;
+		uint16_t crc;			///< over the fields above
+	};
+
+	Eeprom24& m_eeprom;
+	const uint32_t m_address;
+	const uint16_t m_pageCount;
+	const uint16_t m_pageSize;
+	Entry* const m_directory;
+	const uint8_t m_entryCount;
+	const uint16_t m_directoryPages;
+	uint32_t* const m_bitmap;
+
+	uint16_t m_freePages = 0;
+	uint16_t m_allocationHint = 0;
+};
+
+
+/** Blob store together with its RAM storage.
+ *
+ * @tparam PageCount	Number of pages of the region, including the directory.
+ * @tparam EntryCount	Number of blob ids.
+ */
+template<uint16_t PageCount, uint8_t EntryCount>
+class Eeprom24BlobStoreBuffer: public Eeprom24BlobStore
+{
+public:
+	Eeprom24BlobStoreBuffer(Eeprom24& eeprom, uint32_t address):
+		Eeprom24BlobStore(eeprom, address, PageCount, m_entries, EntryCount, m_words) {};
+
+private:
+	Entry m_entries[EntryCount];
+	uint32_t m_words[(PageCount + 31) / 32];
+};
+
+#endif /* EEPROM24_BLOB_H_ */
@@ -0,0 +1,427 @@
+/* eeprom24_bus.cpp
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#include "eeprom24_bus.h"
+
+
+Eeprom24Bus::Eeprom24Bus(I2C_HandleTypeDef* i2c):
+	m_i2c(i2c)
+{
+#if EEPROM24_OS != EEPROM24_OS_NONE
+	m_lock = {Eeprom24Os::Mutex::lockHook, Eeprom24Os::Mutex::unlockHook, &m_mutex};
+#endif
+}
+
+
+/** Registers a device with the bus; it takes part in job scheduling and accounting from then on.
+ *
+ * @param client		Client to attach; must stay valid for the lifetime of the bus.
+ */
+void Eeprom24Bus::attach(Client* client)
+{
+	if (client->attached)
+		return;
+
+	lock();
+	client->next = m_clients;
+	client->attached = true;
+	m_clients = client;
+	unlock();
+}
+
+
+/** Takes the bus for a transaction; blocks in the lock hook while another client owns it.
+ *
+ * @param client		Client the following transfers are accounted to, may be null.
+ */
+void Eeprom24Bus::begin(Client* client)
+{
+	lock();
+	m_current = client;
+
+	if (client)
+		client->transactions++;
+}
+
+
+/** Releases the bus after a transaction.
+ *
+ */
+void Eeprom24Bus::end(void)
+{
+	m_current = nullptr;
+	unlock();
+}
+
+
+/** Transmits data over the bus; must be called inside a transaction.
+ *
+ * @param devAddress	Shifted I2C address of the target device.
+ * @param data			Pointer to data to transmit.
+ * @param length		Number of bytes to transmit.
+ * @param timeout		Timeout in ms.
+ * @return				Status returned by HAL.
+ */
+HAL_StatusTypeDef Eeprom24Bus::transmit(uint16_t devAddress, uint8_t* data, uint16_t length, uint32_t timeout)
+{
+	uint32_t start = EEPROM24_GET_TIME_US();
+#if EEPROM24_OS != EEPROM24_OS_NONE
+	m_transferDone.prepare();
+	auto retval = waitForTransfer(HAL_I2C_Master_Transmit_IT(m_i2c, devAddress, data, length), devAddress, timeout);
+#else
+	auto retval = HAL_I2C_Master_Transmit(m_i2c, devAddress, data, length, timeout);
+#endif
+	account(start, length);
+	return retval;
+}
+
+
+/** Receives data from the bus; must be called inside a transaction.
+ *
+ * @param devAddress	Shifted I2C address of the target device.
+ * @param data			Pointer to an array in which data will be stored.
+ * @param length		Number of bytes to receive.
+ * @param timeout		Timeout in ms.
+ * @return				Status returned by HAL.
+ */
+HAL_StatusTypeDef Eeprom24Bus::receive(uint16_t devAddress, uint8_t* data, uint16_t length, uint32_t timeout)
+{
+	uint32_t start = EEPROM24_GET_TIME_US();
+#if EEPROM24_OS != EEPROM24_OS_NONE
+	m_transferDone.prepare();
+	auto retval = waitForTransfer(HAL_I2C_Master_Receive_IT(m_i2c, devAddress, data, length), devAddress, timeout);
+#else
+	auto retval = HAL_I2C_Master_Receive(m_i2c, devAddress, data, length, timeout);
+#endif
+	account(start, length);
+	return retval;
+}
+
+
+/** Address probe, used for ready polling; must be called inside a transaction.
+ *
+ * @param devAddress	Shifted I2C address of the target device.
+ * @param trials		Number of probe attempts.
+ * @param timeout		Timeout in ms.
+ * @return				Status returned by HAL.
+ */
+HAL_StatusTypeDef Eeprom24Bus::isDeviceReady(uint16_t devAddress, uint32_t trials, uint32_t timeout)
+{
+	uint32_t start = EEPROM24_GET_TIME_US();
+	auto retval = HAL_I2C_IsDeviceReady(m_i2c, devAddress, trials, timeout);
+	account(start, 0);
+	return retval;
+}
+
+
+/** Starts an interrupt driven receive and returns immediately, so the caller can work while it is in flight; must be
+ *  called inside a transaction and completed with finishTransfer() before the next transfer.
+ *
+ * @param devAddress	Shifted I2C address of the target device.
+ * @param data			Pointer to an array in which data will be stored; must stay valid until the transfer finishes.
+ * @param length		Number of bytes to receive.
+ * @return				Status returned by HAL.
+ */
+HAL_StatusTypeDef Eeprom24Bus::startReceive(uint16_t devAddress, uint8_t* data, uint16_t length)
+{
+	m_transferStart = EEPROM24_GET_TIME_US();
+	m_transferLength = length;
+#if EEPROM24_OS != EEPROM24_OS_NONE
+	m_transferDone.prepare();
+#endif
+	return HAL_I2C_Master_Receive_IT(m_i2c, devAddress, data, length);
+}
+
+
+/** Waits for a transfer started by startReceive(); aborts it on timeout.
+ *
+ * @param devAddress	Shifted I2C address of the target device.
+ * @param timeout		Timeout in ms.
+ * @return				Status of the finished transfer.
+ */
+HAL_StatusTypeDef Eeprom24Bus::finishTransfer(uint16_t devAddress, uint32_t timeout)
+{
+#if EEPROM24_OS != EEPROM24_OS_NONE
+	auto retval = waitForTransfer(HAL_OK, devAddress, timeout);
+#else
+	auto retval = pollTransfer(m_i2c, devAddress, timeout);
+#endif
+	account(m_transferStart, m_transferLength);
+	return retval;
+}
+
+
+/** Busy-waits for an interrupt driven transfer by polling the handle state, for use without the completion callbacks.
+ *
+ * @param i2c			Handle the transfer runs on.
+ * @param devAddress	Shifted I2C address of the target device.
+ * @param timeout		Timeout in ms.
+ * @return				HAL_OK once the handle is ready, HAL_ERROR if the transfer failed, HAL_TIMEOUT otherwise.
+ */
+HAL_StatusTypeDef Eeprom24Bus::pollTransfer(I2C_HandleTypeDef* i2c, uint16_t devAddress, uint32_t timeout)
+{
+	uint32_t start = HAL_GetTick();
+
+	while (HAL_I2C_GetState(i2c) != HAL_I2C_STATE_READY)
+	{
+		if (HAL_GetTick() - start > timeout)
+		{
+			HAL_I2C_Master_Abort_IT(i2c, devAddress);
+			return HAL_TIMEOUT;
+		}
+	}
+
+	return (HAL_I2C_GetError(i2c) == HAL_I2C_ERROR_NONE) ? HAL_OK : HAL_ERROR;
+}
+
+
+/** Queues a transfer of a client; it will be run while an EEPROM waits for its write cycle, or by runPending().
+ *  Must not be called from inside a transaction.
+ *
+ * @param client		Client the job belongs to, gets attached if it isn't yet.
+ * @param job			Job to run; must stay valid until it has been run.
+ */
+void Eeprom24Bus::post(Client* client, Job* job)
+{
+	attach(client);
+
+	lock();
+	job->next = nullptr;
+
+	if (client->tail)
+		client->tail->next = job;
+	else
+		client->head = job;
+
+	client->tail = job;
+	client->pending++;
+	m_pendingCount++;
+	unlock();
+}
+
+
+/** Runs one pending job. Clients are served round-robin, so a client with a long queue can't starve the others.
+ *
+ * @return				True if a job was run.
+ */
+bool Eeprom24Bus::runPending(void)
+{
+	begin(nullptr);
+
+	if (m_pendingCount == 0)
+	{
+		end();
+		return false;
+	}
+
+	Client* client = m_nextToServe ? m_nextToServe : m_clients;
+	for (Client* c = m_clients; c != nullptr && client->head == nullptr; c = c->next)
+		client = client->next ? client->next : m_clients;
+
+	Job* job = client->head;
+	if (job == nullptr)
+	{
+		end();
+		return false;
+	}
+
+	client->head = job->next;
+	if (client->head == nullptr)
+		client->tail = nullptr;
+	client->pending--;
+	m_pendingCount--;
+	m_nextToServe = client->next;
+
+	m_current = client;
+	client->transactions++;
+
+	uint32_t start = EEPROM24_GET_TIME_US();
+	job->run(m_i2c, job->context);
+	account(start, 0);
+
+	end();
+	return true;
+}
+
+
+/** Gives the bus away for the given time: pending jobs of other clients are run first, the rest is slept through.
+ *  Must not be called from inside a transaction.
+ *
+ * @param time			Time to yield in us.
+ */
+void Eeprom24Bus::yield(uint32_t time)
+{
+	uint32_t start = EEPROM24_GET_TIME_US();
+
+	while (EEPROM24_GET_TIME_US() - start < time)
+	{
+		if (!runPending())
+		{
+			EEPROM24_DELAY_US(time - (EEPROM24_GET_TIME_US() - start));
+			break;
+		}
+	}
+}
+
+
+/** Interval between ready probes; the busier the bus and the more work other clients have queued, the longer it is.
+ *  Must not be called from inside a transaction.
+ *
+ * @return				Poll interval in us.
+ */
+uint32_t Eeprom24Bus::getPollInterval(void)
+{
+	lock();
+	account(EEPROM24_GET_TIME_US(), 0);
+	uint32_t interval = EEPROM24_POLL_INTERVAL_US * (1 + m_pendingCount);
+
+	if (m_utilization > 50)
+		interval *= 2;
+	unlock();
+
+	return (interval > EEPROM24_POLL_INTERVAL_MAX_US) ? EEPROM24_POLL_INTERVAL_MAX_US : interval;
+}
+
+
+/** Number of jobs queued by all clients.
+ *
+ * @return				Pending job count.
+ */
+uint8_t Eeprom24Bus::getPendingCount(void) const
+{
+	lock();
+	uint8_t count = m_pendingCount;
+	unlock();
+	return count;
+}
+
+
+/** Share of time the bus spent transferring data during the last complete measurement window.
+ *  Must not be called from inside a transaction.
+ *
+ * @return				Utilization in percent.
+ */
+uint8_t Eeprom24Bus::getUtilization(void)
+{
+	lock();
+	account(EEPROM24_GET_TIME_US(), 0);
+	uint8_t utilization = m_utilization;
+	unlock();
+	return utilization;
+}
+
+
+/** Share of the accounted bus time used by a client since the last resetStats().
+ *
+ * @param client		Client to check.
+ * @return				Share in percent.
+ */
+uint8_t Eeprom24Bus::getShare(const Client* client) const
+{
+	lock();
+	uint8_t share = (m_totalBusyTime == 0) ? 0 : (uint64_t)client->busyTime * 100 / m_totalBusyTime;
+	unlock();
+	return share;
+}
+
+
+/** Clears per-client bandwidth accounting.
+ *
+ */
+void Eeprom24Bus::resetStats(void)
+{
+	lock();
+	for (Client* c = m_clients; c != nullptr; c = c->next)
+	{
+		c->transactions = 0;
+		c->bytes = 0;
+		c->busyTime = 0;
+	}
+	m_totalBusyTime = 0;
+	unlock();
+}
+
+
+/** To be called from HAL_I2C_MasterTxCpltCallback / HAL_I2C_MasterRxCpltCallback for this bus's handle.
+ *
+ */
+void Eeprom24Bus::onTransferComplete(void)
+{
+#if EEPROM24_OS != EEPROM24_OS_NONE
+	m_transferStatus = HAL_OK;
+	m_transferDone.raiseFromIsr();
+#endif
+}
+
+
+/** To be called from HAL_I2C_ErrorCallback / HAL_I2C_AbortCpltCallback for this bus's handle.
+ *
+ */
+void Eeprom24Bus::onTransferError(void)
+{
+#if EEPROM24_OS != EEPROM24_OS_NONE
+	m_transferStatus = HAL_ERROR;
+	m_transferDone.raiseFromIsr();
+#endif
+}
+
+
+/** Sleeps until an interrupt driven transfer finishes; aborts it on timeout.
+ *
+ * @param started		Status returned by the HAL function starting the transfer.
+ * @param devAddress	Shifted I2C address of the target device.
+ * @param timeout		Timeout in ms.
+ * @return				Status of the finished transfer.
+ */
+HAL_StatusTypeDef Eeprom24Bus::waitForTransfer(HAL_StatusTypeDef started, uint16_t devAddress, uint32_t timeout)
+{
+#if EEPROM24_OS != EEPROM24_OS_NONE
+	if (started != HAL_OK)
+		return started;
+
+	if (!m_transferDone.wait(timeout))
+	{
+		HAL_I2C_Master_Abort_IT(m_i2c, devAddress);
+		return HAL_TIMEOUT;
+	}
+
+	return m_transferStatus;
+#else
+	(void)devAddress;
+	(void)timeout;
+	return started;
+#endif
+}
+
+
+/** Accounts the time since start to the current client and to the current utilization window; the caller must hold
+ *  the bus lock.
+ *
+ * @param start			Start of the transfer in us.
+ * @param length		Number of data bytes transferred.
+ */
+void Eeprom24Bus::account(uint32_t start, uint16_t length)
+{
+	uint32_t now = EEPROM24_GET_TIME_US();
+	uint32_t busy = now - start;
+
+	m_windowBusy += busy;
+	m_totalBusyTime += busy;
+
+	if (m_current)
+	{
+		m_current->busyTime += busy;
+		m_current->bytes += length;
+	}
+
+	uint32_t window = now - m_windowStart;
+	if (window >= EEPROM24_BUS_WINDOW_US)
+	{
+		uint32_t windowBusy = (m_windowBusy > window) ? window : m_windowBusy;
+		m_utilization = (uint64_t)windowBusy * 100 / window;
+		m_windowStart = now;
+		m_windowBusy = 0;
+	}
+}
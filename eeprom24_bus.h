@@ -0,0 +1,128 @@
+/* eeprom24_bus.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_BUS_H_
+#define EEPROM24_BUS_H_
+
+#include "hal_inc.h"
+#include "eeprom24_config.h"
+#include "eeprom24_os.h"
+
+/** I2C bus shared by EEPROMs and other devices. The bus owns the handle; every device is a Client, whose transfers are
+ *  serialized by the (optional) lock hooks and accounted per client. While an EEPROM waits for its write cycle to
+ *  finish, it yields the bus: transfers queued by other clients are run in the tWR window, one job per client in
+ *  round-robin order, and the ready-poll rate is lowered if the bus is busy.
+ *
+ *  With an RTOS selected (EEPROM24_OS), the bus guards itself with its own mutex and transfers are interrupt driven:
+ *  the calling task sleeps until onTransferComplete() / onTransferError() is called from the HAL I2C callbacks. All
+ *  queue and accounting state is only touched with the lock held, so the statistics getters take it too and must not
+ *  be called from inside a transaction.
+ */
+class Eeprom24Bus
+{
+public:
+	/** A transfer of a device sharing the bus; run() performs the whole transaction on the given handle. */
+	struct Job
+	{
+		bool (*run)(I2C_HandleTypeDef* i2c, void* context);
+		void* context;
+		Job* next;
+	};
+
+	/** A device on the bus, holds its job queue and bandwidth accounting. */
+	struct Client
+	{
+		Job* head = nullptr;
+		Job* tail = nullptr;
+		uint8_t pending = 0;
+
+		uint32_t transactions = 0;
+		uint32_t bytes = 0;
+		uint32_t busyTime = 0;
+
+		Client* next = nullptr;
+		bool attached = false;
+	};
+
+	/** Locking hooks, e.g. around an RTOS mutex; without them the bus assumes a single thread of execution. */
+	struct Lock
+	{
+		void (*lock)(void* context);
+		void (*unlock)(void* context);
+		void* context;
+	};
+
+	/** Owns the bus for its lifetime; transfers made meanwhile are accounted to the client. A null bus is allowed. */
+	class Transaction
+	{
+	public:
+		Transaction(Eeprom24Bus* bus, Client* client): m_bus(bus) {if (m_bus) m_bus->begin(client);};
+		~Transaction() {if (m_bus) m_bus->end();};
+
+	private:
+		Eeprom24Bus* const m_bus;
+	};
+
+	Eeprom24Bus(I2C_HandleTypeDef* i2c);
+
+	void setLock(const Lock& lock) {m_lock = lock;};
+	void attach(Client* client);
+	void begin(Client* client);
+	void end(void);
+
+	HAL_StatusTypeDef transmit(uint16_t devAddress, uint8_t* data, uint16_t length, uint32_t timeout);
+	HAL_StatusTypeDef receive(uint16_t devAddress, uint8_t* data, uint16_t length, uint32_t timeout);
+	HAL_StatusTypeDef isDeviceReady(uint16_t devAddress, uint32_t trials, uint32_t timeout);
+
+	HAL_StatusTypeDef startReceive(uint16_t devAddress, uint8_t* data, uint16_t length);
+	HAL_StatusTypeDef finishTransfer(uint16_t devAddress, uint32_t timeout);
+	static HAL_StatusTypeDef pollTransfer(I2C_HandleTypeDef* i2c, uint16_t devAddress, uint32_t timeout);
+
+	void post(Client* client, Job* job);
+	bool runPending(void);
+	uint8_t getPendingCount(void) const;
+
+	void yield(uint32_t time);
+	uint32_t getPollInterval(void);
+	uint8_t getUtilization(void);
+
+	uint8_t getShare(const Client* client) const;
+	void resetStats(void);
+
+	I2C_HandleTypeDef* getHandle(void) const {return m_i2c;};
+
+	void onTransferComplete(void);
+	void onTransferError(void);
+
+protected:
+	void lock(void) const {if (m_lock.lock) m_lock.lock(m_lock.context);};
+	void unlock(void) const {if (m_lock.unlock) m_lock.unlock(m_lock.context);};
+	void account(uint32_t start, uint16_t length);
+	HAL_StatusTypeDef waitForTransfer(HAL_StatusTypeDef started, uint16_t devAddress, uint32_t timeout);
+
+	I2C_HandleTypeDef* const m_i2c;
+	Lock m_lock = {nullptr, nullptr, nullptr};
+
+	Client* m_clients = nullptr;
+	Client* m_current = nullptr;
+	Client* m_nextToServe = nullptr;
+	uint8_t m_pendingCount = 0;
+
+	uint32_t m_totalBusyTime = 0;
+	uint32_t m_windowStart = 0;
+	uint32_t m_windowBusy = 0;
+	uint8_t m_utilization = 0;
+
+	uint32_t m_transferStart = 0;
+	uint16_t m_transferLength = 0;
+
+#if EEPROM24_OS != EEPROM24_OS_NONE
+	Eeprom24Os::Mutex m_mutex;
+	Eeprom24Os::Signal m_transferDone;
+	volatile HAL_StatusTypeDef m_transferStatus = HAL_OK;
+#endif
+};
+
+#endif /* EEPROM24_BUS_H_ */
@@ -0,0 +1,110 @@
+/* eeprom24_config.h
+ *
+ * Created on: Oct 17, 2026
+ *
+ * Compile-time configuration of the Eeprom24 library; define any of these before including the headers to override.
+ */
+
+#ifndef EEPROM24_CONFIG_H_
+#define EEPROM24_CONFIG_H_
+
+#include "hal_inc.h"
+
+#define EEPROM24_OS_NONE			0
+#define EEPROM24_OS_FREERTOS		1
+#define EEPROM24_OS_PTHREAD			2
+
+/** Operating system adapter; with an RTOS, bus transfers are interrupt driven and waits block the calling task. That
+ *  only applies to EEPROMs attached to an Eeprom24Bus (Eeprom24::setBus()); without one, an Eeprom24 makes blocking HAL
+ *  calls, and nothing serializes the tasks using its I2C handle. */
+#ifndef EEPROM24_OS
+#define EEPROM24_OS					EEPROM24_OS_NONE
+#endif
+
+/** Whether the I2C event and error interrupts are enabled, so that HAL_I2C_*_IT transfers complete. Without them,
+ *  exportTo() uses blocking reads instead of overlapping the sink with the next read; the RTOS adapters require them. */
+#ifndef EEPROM24_I2C_IT
+#define EEPROM24_I2C_IT				(EEPROM24_OS != EEPROM24_OS_NONE)
+#endif
+
+#if EEPROM24_OS != EEPROM24_OS_NONE && !EEPROM24_I2C_IT
+#error "The RTOS adapters need the I2C interrupts (EEPROM24_I2C_IT)"
+#endif
+
+/** Task notification index used by the FreeRTOS completion signal. Index 0 is left to the application (and to stream
+ *  buffers); configTASK_NOTIFICATION_ARRAY_ENTRIES must be larger than this. */
+#ifndef EEPROM24_NOTIFY_INDEX
+#define EEPROM24_NOTIFY_INDEX		1
+#endif
+
+#ifndef EEPROM24_I2C_TIMEOUT
+#define EEPROM24_I2C_TIMEOUT		25
+#endif
+
+/** Worst-case write cycle time from the datasheet, in us; used until the actual tWR has been learned. */
+#ifndef EEPROM24_TWR_MAX_US
+#define EEPROM24_TWR_MAX_US			5000
+#endif
+
+/** Microsecond timebase used for tWR calibration; define as a DWT/timer based counter for better resolution. */
+#ifndef EEPROM24_GET_TIME_US
+#define EEPROM24_GET_TIME_US()		(HAL_GetTick() * 1000)
+#endif
+
+/** Resolution of EEPROM24_GET_TIME_US and EEPROM24_DELAY_US; the first ready probe is scheduled at least this much
+ *  earlier, in whole units of it. */
+#ifndef EEPROM24_TIME_RESOLUTION_US
+#define EEPROM24_TIME_RESOLUTION_US	1000
+#endif
+
+/** Delay used while waiting for the write cycle; with an RTOS, it yields the CPU to other tasks. */
+#ifndef EEPROM24_DELAY_US
+#define EEPROM24_DELAY_US(us)		Eeprom24Os::delayUs(us)
+#endif
+
+/** Base ready-poll interval while an EEPROM is in its write cycle, in us. */
+#ifndef EEPROM24_POLL_INTERVAL_US
+#define EEPROM24_POLL_INTERVAL_US	1000
+#endif
+
+/** Upper limit of the poll interval when other devices are competing for the bus, in us. */
+#ifndef EEPROM24_POLL_INTERVAL_MAX_US
+#define EEPROM24_POLL_INTERVAL_MAX_US	4000
+#endif
+
+/** Length of the window over which bus utilization is measured, in us. */
+#ifndef EEPROM24_BUS_WINDOW_US
+#define EEPROM24_BUS_WINDOW_US		20000
+#endif
+
+/** Largest page size of the supported memories; sizes RAM page buffers of the storage layers. */
+#ifndef EEPROM24_MAX_PAGE_SIZE
+#define EEPROM24_MAX_PAGE_SIZE		128
+#endif
+
+/** Bus time per transferred byte, used for cost estimates; the default matches 400 kHz. */
+#ifndef EEPROM24_BYTE_TIME_US
+#define EEPROM24_BYTE_TIME_US		23
+#endif
+
+/** Time available for the emergency flush after a low-voltage warning, in us. */
+#ifndef EEPROM24_EMERGENCY_BUDGET_US
+#define EEPROM24_EMERGENCY_BUDGET_US	20000
+#endif
+
+/** Size of the LZ compression window as a power of two; the compressor and decompressor each keep this much history. */
+#ifndef EEPROM24_LZ_WINDOW_BITS
+#define EEPROM24_LZ_WINDOW_BITS		8
+#endif
+
+/** Bits of the LZ match length, 1 to 15; the longest match is 2^bits + 1 bytes, which the writer buffers as lookahead. */
+#ifndef EEPROM24_LZ_LENGTH_BITS
+#define EEPROM24_LZ_LENGTH_BITS		4
+#endif
+
+/** Rated write endurance of a page, used for lifetime projections. */
+#ifndef EEPROM24_ENDURANCE_CYCLES
+#define EEPROM24_ENDURANCE_CYCLES	1000000
+#endif
+
+#endif /* EEPROM24_CONFIG_H_ */
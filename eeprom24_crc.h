@@ -0,0 +1,29 @@
+/* eeprom24_crc.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_CRC_H_
+#define EEPROM24_CRC_H_
+
+#include <stdint.h>
+
+/** CRC-16/CCITT-FALSE, bitwise; pass the previous result as crc to continue over several buffers.
+ *
+ * @param data			Pointer to data.
+ * @param length		Number of bytes.
+ * @param crc			Initial value.
+ * @return				CRC of the data.
+ */
+inline uint16_t eeprom24Crc16(const uint8_t* data, uint32_t length, uint16_t crc = 0xFFFF)
+{
+	while (length-- > 0)
+	{
+		crc ^= (uint16_t)(*data++) << 8;
+		for (uint8_t i = 0; i < 8; i++)
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc;
+}
+
+#endif /* EEPROM24_CRC_H_ */
@@ -0,0 +1,289 @@
+/* eeprom24_hashtable.cpp
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#include <string.h>
+#include "eeprom24_hashtable.h"
+
+
+Eeprom24HashTable::Eeprom24HashTable(Eeprom24& eeprom, uint32_t address, uint16_t bucketCount, uint8_t keySize, uint8_t valueSize):
+	m_eeprom(eeprom), m_address(address), m_bucketCount(bucketCount), m_keySize(keySize), m_recordSize(keySize + valueSize),
+	m_pageSize((eeprom.getPageSizeInBytes() < EEPROM24_MAX_PAGE_SIZE) ? eeprom.getPageSizeInBytes() : EEPROM24_MAX_PAGE_SIZE),
+	m_slotsPerBucket(((m_pageSize - HEADER_SIZE) / m_recordSize > 8) ? 8 : (m_pageSize - HEADER_SIZE) / m_recordSize)
+{
+}
+
+
+/** Reads the whole table once to count the entries and fill the Bloom filter, if one is set.
+ *
+ * @return				True if all buckets could be read.
+ */
+bool Eeprom24HashTable::mount(void)
+{
+	if (m_bloom)
+		memset(m_bloom, 0, m_bloomSize);
+	m_entryCount = 0;
+
+	for (uint16_t bucket = 0; bucket < m_bucketCount; bucket++)
+	{
+		if (!readBucket(bucket))
+			return false;
+
+		for (uint8_t slot = 0; slot < m_slotsPerBucket; slot++)
+		{
+			if (freeMask() & (1 << slot))
+				continue;
+
+			m_entryCount++;
+			if (m_bloom)
+				bloomAdd(hash(getSlot(slot)));
+		}
+	}
+
+	return true;
+}
+
+
+/** Clears all bucket headers.
+ *
+ * @return				True if write operation was successful.
+ */
+bool Eeprom24HashTable::format(void)
+{
+	uint8_t header[HEADER_SIZE] = {0xFF, 0xFF};
+	m_bucketIndex = 0xFFFF;
+
+	for (uint16_t bucket = 0; bucket < m_bucketCount; bucket++)
+	{
+		if (!m_eeprom.write(getBucketAddress(bucket), header, sizeof(header)))
+			return false;
+	}
+
+	if (m_bloom)
+		memset(m_bloom, 0, m_bloomSize);
+	m_entryCount = 0;
+	return true;
+}
+
+
+/** Looks a key up.
+ *
+ * @param key			Key, keySize bytes.
+ * @param value			Receives the value, valueSize bytes.
+ * @return				True if the key was found.
+ */
+bool Eeprom24HashTable::get(const void* key, void* value)
+{
+	m_lookups++;
+	uint32_t h = hash(key);
+
+	if (m_bloom && !bloomTest(h))
+	{
+		m_bloomSkips++;
+		return false;
+	}
+
+	Location location;
+	if (!find(key, h, &location) || !location.found)
+		return false;
+
+	memcpy(value, getSlot(location.slot) + m_keySize, m_recordSize - m_keySize);
+	return true;
+}
+
+
+/** Inserts a record, or updates the value of an existing key; an unchanged value isn't written.
+ *
+ * @param key			Key, keySize bytes.
+ * @param value			Value, valueSize bytes.
+ * @return				False if the table is full or a write failed.
+ */
+bool Eeprom24HashTable::put(const void* key, const void* value)
+{
+	uint32_t h = hash(key);
+	uint8_t valueSize = m_recordSize - m_keySize;
+
+	Location location;
+	if (!find(key, h, &location))
+		return false;
+
+	if (location.found)
+	{
+		if (!readBucket(location.bucket))
+			return false;
+
+		uint8_t* stored = getSlot(location.slot) + m_keySize;
+		if (memcmp(stored, value, valueSize) == 0)
+			return true;
+
+		memcpy(stored, value, valueSize);
+		return m_eeprom.write(getBucketAddress(location.bucket) + (stored - m_bucket), stored, valueSize);
+	}
+
+	if (location.slot == 0xFF)
+		return false;
+
+	//buckets skipped on the way are marked first, so that lookups continue past them
+	for (uint16_t bucket = h % m_bucketCount; bucket != location.bucket; bucket = (bucket + 1) % m_bucketCount)
+	{
+		if (!readBucket(bucket))
+			return false;
+		if (overflow() != 0xFF)
+			continue;
+
+		overflow() = 0;
+		if (!m_eeprom.write(getBucketAddress(bucket) + 1, &overflow(), 1))
+			return false;
+	}
+
+	if (!readBucket(location.bucket))
+		return false;
+
+	uint8_t* slot = getSlot(location.slot);
+	memcpy(slot, key, m_keySize);
+	memcpy(slot + m_keySize, value, valueSize);
+	freeMask() &= ~(1 << location.slot);
+
+	//the record first, then the bit that makes it visible; neither write touches the other slots
+	if (!m_eeprom.write(getBucketAddress(location.bucket) + (slot - m_bucket), slot, m_recordSize) ||
+		!m_eeprom.write(getBucketAddress(location.bucket), &freeMask(), 1))
+	{
+		m_bucketIndex = 0xFFFF;
+		return false;
+	}
+
+	m_entryCount++;
+	if (m_bloom)
+		bloomAdd(h);
+	return true;
+}
+
+
+/** Deletes a key by freeing its slot; overflow marks stay, so other keys remain reachable.
+ *
+ * @param key			Key, keySize bytes.
+ * @return				True if the key was found and deleted.
+ */
+bool Eeprom24HashTable::remove(const void* key)
+{
+	Location location;
+	if (!find(key, hash(key), &location) || !location.found || !readBucket(location.bucket))
+		return false;
+
+	freeMask() |= 1 << location.slot;
+	if (!m_eeprom.write(getBucketAddress(location.bucket), &freeMask(), 1))
+	{
+		m_bucketIndex = 0xFFFF;
+		return false;
+	}
+
+	m_entryCount--;
+	return true;
+}
+
+
+/** Probes buckets from the key's home bucket. The search for the key ends at the first bucket that never overflowed;
+ *  probing goes on only until a free slot for an insert is found.
+ *
+ * @param key			Key to look for.
+ * @param hash			Hash of the key.
+ * @param location		Receives the key's slot, or the first free slot (slot 0xFF if there is none).
+ * @return				False on a read error.
+ */
+bool Eeprom24HashTable::find(const void* key, uint32_t hash, Location* location)
+{
+	*location = {0, 0xFF, false};
+	bool searching = true;
+
+	for (uint16_t probe = 0; probe < m_bucketCount; probe++)
+	{
+		uint16_t bucket = (hash % m_bucketCount + probe) % m_bucketCount;
+		if (!readBucket(bucket))
+			return false;
+
+		for (uint8_t slot = 0; slot < m_slotsPerBucket; slot++)
+		{
+			if (freeMask() & (1 << slot))
+			{
+				if (location->slot == 0xFF)
+				{
+					location->bucket = bucket;
+					location->slot = slot;
+				}
+			}
+			else if (searching && memcmp(getSlot(slot), key, m_keySize) == 0)
+			{
+				*location = {bucket, slot, true};
+				return true;
+			}
+		}
+
+		if (overflow() == 0xFF)
+			searching = false;
+		if (!searching && location->slot != 0xFF)
+			break;
+	}
+
+	return true;
+}
+
+
+/** Reads a bucket into the RAM buffer, unless it is the one already there.
+ *
+ */
+bool Eeprom24HashTable::readBucket(uint16_t bucket)
+{
+	if (bucket == m_bucketIndex)
+		return true;
+
+	m_bucketIndex = 0xFFFF;
+	if (!m_eeprom.read(getBucketAddress(bucket), m_bucket, HEADER_SIZE + m_slotsPerBucket * m_recordSize))
+		return false;
+
+	m_bucketIndex = bucket;
+	m_bucketReads++;
+	return true;
+}
+
+
+/** FNV-1a hash of a key.
+ *
+ */
+uint32_t Eeprom24HashTable::hash(const void* key) const
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(key);
+	uint32_t h = 2166136261;
+
+	for (uint8_t i = 0; i < m_keySize; i++)
+		h = (h ^ bytes[i]) * 16777619;
+	return h;
+}
+
+
+void Eeprom24HashTable::bloomAdd(uint32_t hash)
+{
+	uint32_t bits = (uint32_t)m_bloomSize * 8;
+	uint32_t step = ((hash >> 17) | (hash << 15)) | 1;
+
+	for (uint8_t i = 0; i < BLOOM_HASHES; i++)
+	{
+		uint32_t bit = (hash + i * step) % bits;
+		m_bloom[bit / 8] |= 1 << (bit % 8);
+	}
+}
+
+
+bool Eeprom24HashTable::bloomTest(uint32_t hash) const
+{
+	uint32_t bits = (uint32_t)m_bloomSize * 8;
+	uint32_t step = ((hash >> 17) | (hash << 15)) | 1;
+
+	for (uint8_t i = 0; i < BLOOM_HASHES; i++)
+	{
+		uint32_t bit = (hash + i * step) % bits;
+		if (!(m_bloom[bit / 8] & (1 << (bit % 8))))
+			return false;
+	}
+	return true;
+}
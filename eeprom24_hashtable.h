@@ -0,0 +1,87 @@
+/* eeprom24_hashtable.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_HASHTABLE_H_
+#define EEPROM24_HASHTABLE_H_
+
+#include "eeprom24.h"
+
+/** Hash table of fixed-size records kept in the memory, for lookups by key without loading the table into RAM. Each
+ *  bucket is one page: a 2 byte header followed by up to 8 record slots. Keys are hashed to a home bucket; a full bucket
+ *  is marked as overflowed and the search continues in the next one (linear probing over buckets), so a lookup is
+ *  usually a single page read and stops at the first bucket that never overflowed.
+ *
+ *  In blank memory (0xFF) all slots are free, so the table needs no formatting. An insert writes the record into its
+ *  free slot and then clears the slot's bit in the free mask; overflow marks are written before, so an interrupted
+ *  insert leaves at most a superfluous mark or a record in a slot that is still free. An optional RAM Bloom filter,
+ *  filled by mount(), skips the reads for most absent keys.
+ */
+class Eeprom24HashTable
+{
+public:
+	Eeprom24HashTable(Eeprom24& eeprom, uint32_t address, uint16_t bucketCount, uint8_t keySize, uint8_t valueSize);
+
+	void setBloomFilter(uint8_t* bits, uint16_t size) {m_bloom = bits; m_bloomSize = size;};
+	bool mount(void);
+	bool format(void);
+
+	bool get(const void* key, void* value);
+	bool put(const void* key, const void* value);
+	bool remove(const void* key);
+
+	uint8_t getSlotsPerBucket(void) const {return m_slotsPerBucket;};
+	uint32_t getCapacity(void) const {return (uint32_t)m_bucketCount * m_slotsPerBucket;};
+	uint32_t getEntryCount(void) const {return m_entryCount;};
+
+	uint32_t getLookups(void) const {return m_lookups;};
+	uint32_t getBucketReads(void) const {return m_bucketReads;};
+	uint32_t getBloomSkips(void) const {return m_bloomSkips;};
+	void resetStats(void) {m_lookups = 0; m_bucketReads = 0; m_bloomSkips = 0;};
+
+	static constexpr uint8_t HEADER_SIZE = 2;
+	static constexpr uint8_t BLOOM_HASHES = 3;
+
+protected:
+	/** Where a key was found, or where it can be inserted. */
+	struct Location
+	{
+		uint16_t bucket;
+		uint8_t slot;
+		bool found;
+	};
+
+	//bucket header: free slot mask (a cleared bit is a used slot) and overflow mark (0xFF if never overflowed)
+	uint8_t& freeMask(void) {return m_bucket[0];};
+	uint8_t& overflow(void) {return m_bucket[1];};
+	uint8_t* getSlot(uint8_t slot) {return &m_bucket[HEADER_SIZE + slot * m_recordSize];};
+
+	bool find(const void* key, uint32_t hash, Location* location);
+	bool readBucket(uint16_t bucket);
+	uint32_t getBucketAddress(uint16_t bucket) const {return m_address + (uint32_t)bucket * m_pageSize;};
+	uint32_t hash(const void* key) const;
+	void bloomAdd(uint32_t hash);
+	bool bloomTest(uint32_t hash) const;
+
+	Eeprom24& m_eeprom;
+	const uint32_t m_address;
+	const uint16_t m_bucketCount;
+	const uint8_t m_keySize;
+	const uint8_t m_recordSize;
+	const uint16_t m_pageSize;
+	const uint8_t m_slotsPerBucket;
+
+	uint8_t m_bucket[EEPROM24_MAX_PAGE_SIZE];
+	uint16_t m_bucketIndex = 0xFFFF;
+
+	uint8_t* m_bloom = nullptr;
+	uint16_t m_bloomSize = 0;
+
+	uint32_t m_entryCount = 0;
+	uint32_t m_lookups = 0;
+	uint32_t m_bucketReads = 0;
+	uint32_t m_bloomSkips = 0;
+};
+
+#endif /* EEPROM24_HASHTABLE_H_ */
@@ -0,0 +1,203 @@
+/* eeprom24_journal.cpp
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "eeprom24_crc.h"
+#include "eeprom24_journal.h"
+
+
+Eeprom24Journal::Eeprom24Journal(Eeprom24& eeprom, uint32_t address, uint8_t slotCount, uint16_t* targets):
+	m_eeprom(eeprom), m_address(address),
+	m_pageSize((eeprom.getPageSizeInBytes() < EEPROM24_MAX_PAGE_SIZE) ? eeprom.getPageSizeInBytes() : EEPROM24_MAX_PAGE_SIZE),
+	m_slotCount((slotCount > (m_pageSize - sizeof(Header)) / 2) ? (m_pageSize - sizeof(Header)) / 2 : slotCount),
+	m_targets(targets)
+{
+}
+
+
+/** Finishes a transaction interrupted after its commit; an uncommitted one is dropped. The sequence continues from
+ *  the stored header, so the next commit never repeats the header left from the last one.
+ *
+ * @return				True if the journal could be read and a committed transaction was replayed.
+ */
+bool Eeprom24Journal::mount(void)
+{
+	m_open = false;
+	m_applyPending = false;
+	m_count = 0;
+
+	Header header;
+	if (!m_eeprom.read(m_address, reinterpret_cast<uint8_t*>(&header), sizeof(header)))
+		return false;
+	if (header.magic != MAGIC)
+		return true;
+
+	m_sequence = header.sequence;
+	if (header.state != STATE_COMMITTED)
+		return true;
+
+	//a torn header write is treated as no commit
+	if (header.count > m_slotCount)
+		return true;
+	if (!m_eeprom.read(m_address + sizeof(header), reinterpret_cast<uint8_t*>(m_targets), header.count * sizeof(uint16_t)))
+		return false;
+	if (getCrc(header) != header.crc)
+		return true;
+
+	m_count = header.count;
+	m_replays++;
+	m_applyPending = true;
+	return apply();
+}
+
+
+/** Starts a transaction; an open one is dropped. A committed transaction not applied yet is applied first.
+ *
+ * @return				False if the pending transaction could not be applied; no transaction is open then.
+ */
+bool Eeprom24Journal::begin(void)
+{
+	m_open = false;
+	if (m_applyPending && !apply())
+		return false;
+
+	m_count = 0;
+	m_open = true;
+	return true;
+}
+
+
+/** Stages a write; the data reaches its address only with commit(). A page written several times within a transaction
+ *  takes a single slot.
+ *
+ * @param address		Address to start writing at.
+ * @param data			Pointer to an array with data to be written.
+ * @param length		How many bytes to write.
+ * @return				False if no transaction is open, the journal is full or a write failed.
+ */
+bool Eeprom24Journal::write(uint32_t address, const uint8_t* data, uint32_t length)
+{
+	if (!m_open || address + length > m_eeprom.getSizeInBytes())
+		return false;
+
+	while (length > 0)
+	{
+		uint16_t offset = address % m_pageSize;
+		uint16_t chunk = m_pageSize - offset;
+		if (chunk > length)
+			chunk = length;
+
+		if (!stage(address / m_pageSize, offset, data, chunk))
+			return false;
+
+		address += chunk;
+		data += chunk;
+		length -= chunk;
+	}
+
+	return true;
+}
+
+
+/** Commits the transaction with a single header write, then copies the staged pages in place.
+ *
+ * @return				True if the transaction was committed and applied. On false, the next begin() or mount()
+ * 						finishes it if the header was written.
+ */
+bool Eeprom24Journal::commit(void)
+{
+	if (!m_open)
+		return false;
+
+	m_open = false;
+	if (m_count == 0)
+		return true;
+
+	Header header = {MAGIC, STATE_COMMITTED, m_count, ++m_sequence, 0};
+	header.crc = getCrc(header);
+
+	uint8_t buffer[sizeof(header) + m_count * sizeof(uint16_t)];
+	memcpy(buffer, &header, sizeof(header));
+	memcpy(buffer + sizeof(header), m_targets, m_count * sizeof(uint16_t));
+
+	//from here on the slots belong to the journal until apply() has cleared it
+	m_applyPending = true;
+	if (!m_eeprom.write(m_address, buffer, sizeof(buffer)))
+		return false;
+
+	return apply();
+}
+
+
+/** Merges a write into the page image of its slot, taking a new slot for a page not staged yet.
+ *
+ */
+bool Eeprom24Journal::stage(uint32_t page, uint16_t offset, const uint8_t* data, uint16_t length)
+{
+	uint8_t image[m_pageSize];
+	uint8_t slot = 0;
+	while (slot < m_count && m_targets[slot] != page)
+		slot++;
+
+	if (slot < m_count)
+	{
+		if (!m_eeprom.read(getSlotAddress(slot), image, m_pageSize))
+			return false;
+	}
+	else
+	{
+		if (m_count == m_slotCount)
+			return false;
+		if (length < m_pageSize && !m_eeprom.read(page * m_pageSize, image, m_pageSize))
+			return false;
+	}
+
+	memcpy(image + offset, data, length);
+	if (!m_eeprom.write(getSlotAddress(slot), image, m_pageSize))
+		return false;
+
+	if (slot == m_count)
+		m_targets[m_count++] = page;
+	return true;
+}
+
+
+/** Copies the staged pages to their places and marks the journal clean. Repeating it after an interruption is harmless.
+ *
+ */
+bool Eeprom24Journal::apply(void)
+{
+	uint8_t image[m_pageSize];
+
+	for (uint8_t slot = 0; slot < m_count; slot++)
+	{
+		if (!m_eeprom.read(getSlotAddress(slot), image, m_pageSize) ||
+			!m_eeprom.write((uint32_t)m_targets[slot] * m_pageSize, image, m_pageSize))
+			return false;
+	}
+
+	//the clean header gets a CRC of its own: left with the CRC of the commit, a later commit torn before its own CRC
+	//would still pass as the old one, replaying the old targets with the new slots
+	Header header = {MAGIC, STATE_CLEAN, 0, m_sequence, 0};
+	header.crc = getCrc(header);
+	const uint8_t* clean = reinterpret_cast<const uint8_t*>(&header) + offsetof(Header, state);
+	if (!m_eeprom.write(m_address + offsetof(Header, state), clean, sizeof(header) - offsetof(Header, state)))
+		return false;
+
+	m_count = 0;
+	m_applyPending = false;
+	return true;
+}
+
+
+uint16_t Eeprom24Journal::getCrc(const Header& header) const
+{
+	Header copy = header;
+	copy.crc = 0;
+
+	uint16_t crc = eeprom24Crc16(reinterpret_cast<const uint8_t*>(&copy), sizeof(copy));
+	return eeprom24Crc16(reinterpret_cast<const uint8_t*>(m_targets), header.count * sizeof(uint16_t), crc);
+}
@@ -0,0 +1,77 @@
+/* eeprom24_journal.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_JOURNAL_H_
+#define EEPROM24_JOURNAL_H_
+
+#include "eeprom24.h"
+
+/** Atomic updates of several records, through a redo journal. Between begin() and commit(), written pages are merged
+ *  with their current content and staged in the journal, the records themselves stay untouched. commit() writes the
+ *  journal header listing the staged pages - from then on the transaction counts as done - copies the pages to their
+ *  places and clears the header.
+ *
+ *  After a reset, mount() reads the header: a clean journal costs an 8 byte read. A committed transaction is
+ *  replayed, an uncommitted one is simply dropped (nothing was written in place yet), so either all or none of the
+ *  writes of a transaction reach the records. Clearing rewrites the header as clean with a CRC of its own and keeps
+ *  the sequence, which mount() continues from, so what is left of an old commit never validates a torn new one. Commit
+ *  costs the header write and its clearing on top of writing each staged page twice.
+ *
+ *  A transaction whose copying failed, in commit() or mount(), stays committed in the journal: begin() finishes it
+ *  first and refuses to start a new one, which would overwrite its slots, until it is applied and cleared. A failed
+ *  commit() may have written the header, so its transaction may still be applied, as it would be after a reset.
+ *
+ *  The journal region is one header page followed by slotCount page slots; targets is RAM for slotCount page indexes.
+ */
+class Eeprom24Journal
+{
+public:
+	Eeprom24Journal(Eeprom24& eeprom, uint32_t address, uint8_t slotCount, uint16_t* targets);
+
+	bool mount(void);
+
+	bool begin(void);
+	bool write(uint32_t address, const uint8_t* data, uint32_t length);
+	bool commit(void);
+	void abort(void) {m_open = false;};
+
+	bool isOpen(void) const {return m_open;};
+	bool isApplyPending(void) const {return m_applyPending;};
+	uint8_t getStagedPages(void) const {return m_count;};
+	uint32_t getReplays(void) const {return m_replays;};
+
+	static constexpr uint16_t MAGIC = 0x4A24;
+	static constexpr uint8_t STATE_COMMITTED = 0xC3;
+	static constexpr uint8_t STATE_CLEAN = 0x00;
+
+protected:
+	struct Header
+	{
+		uint16_t magic;
+		uint8_t state;
+		uint8_t count;
+		uint16_t sequence;
+		uint16_t crc;		///< over the header with crc = 0 and its count of targets
+	};
+
+	bool stage(uint32_t page, uint16_t offset, const uint8_t* data, uint16_t length);
+	bool apply(void);
+	uint16_t getCrc(const Header& header) const;
+	uint32_t getSlotAddress(uint8_t slot) const {return m_address + (uint32_t)(slot + 1) * m_pageSize;};
+
+	Eeprom24& m_eeprom;
+	const uint32_t m_address;
+	const uint16_t m_pageSize;
+	const uint8_t m_slotCount;
+	uint16_t* const m_targets;
+
+	uint8_t m_count = 0;
+	uint16_t m_sequence = 0;
+	bool m_open = false;
+	bool m_applyPending = false;
+	uint32_t m_replays = 0;
+};
+
+#endif /* EEPROM24_JOURNAL_H_ */
@@ -0,0 +1,101 @@
+/* eeprom24_lfs.cpp
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#include <string.h>
+#include "eeprom24_lfs.h"
+#include "custom_assert.h"
+
+
+/** Sets up the littlefs configuration for a region of the memory.
+ *
+ * @param eeprom		Memory to use.
+ * @param address		Start of the region, block aligned.
+ * @param size			Size of the region in bytes; the part beyond the last whole block is unused.
+ * @param blockSize		Size of littlefs blocks, a multiple of the page size and at least 128 B.
+ */
+Eeprom24Lfs::Eeprom24Lfs(Eeprom24& eeprom, uint32_t address, uint32_t size, uint16_t blockSize):
+	m_eeprom(eeprom), m_address(address)
+{
+	uint16_t pageSize = (eeprom.getPageSizeInBytes() < EEPROM24_MAX_PAGE_SIZE) ? eeprom.getPageSizeInBytes() : EEPROM24_MAX_PAGE_SIZE;
+	uint32_t blockCount = size / blockSize;
+	assert(blockSize % pageSize == 0);
+	assert(address % blockSize == 0);
+
+	//the lookahead bitmap covers all blocks if it fits a page, it must be a multiple of 8 bytes
+	uint32_t lookahead = ((blockCount + 63) / 64) * 8;
+	if (lookahead > pageSize)
+		lookahead = pageSize & ~7;
+
+	memset(&m_config, 0, sizeof(m_config));
+	m_config.context = this;
+	m_config.read = read;
+	m_config.prog = prog;
+	m_config.erase = erase;
+	m_config.sync = sync;
+
+	m_config.read_size = 1;
+	m_config.prog_size = pageSize;
+	m_config.block_size = blockSize;
+	m_config.block_count = blockCount;
+	m_config.block_cycles = BLOCK_CYCLES;
+	m_config.cache_size = pageSize;
+	m_config.lookahead_size = lookahead;
+
+	m_config.read_buffer = m_readBuffer;
+	m_config.prog_buffer = m_progBuffer;
+	m_config.lookahead_buffer = m_lookaheadBuffer;
+}
+
+
+/** Reads with a single sequential transfer; a write cycle still running is waited for first.
+ *
+ */
+int Eeprom24Lfs::read(const struct lfs_config* c, lfs_block_t block, lfs_off_t off, void* buffer, lfs_size_t size)
+{
+	Eeprom24Lfs* device = static_cast<Eeprom24Lfs*>(c->context);
+	device->m_reads++;
+
+	if (!device->m_eeprom.read(device->getAddress(block, off), static_cast<uint8_t*>(buffer), size))
+		return LFS_ERR_IO;
+	return LFS_ERR_OK;
+}
+
+
+/** Writes whole pages; returns without waiting for the write cycle, the next access does.
+ *
+ */
+int Eeprom24Lfs::prog(const struct lfs_config* c, lfs_block_t block, lfs_off_t off, const void* buffer, lfs_size_t size)
+{
+	Eeprom24Lfs* device = static_cast<Eeprom24Lfs*>(c->context);
+	device->m_progs++;
+
+	if (!device->m_eeprom.write(device->getAddress(block, off), static_cast<const uint8_t*>(buffer), size))
+		return LFS_ERR_IO;
+	return LFS_ERR_OK;
+}
+
+
+/** EEPROM cells are rewritten in place, nothing to erase.
+ *
+ */
+int Eeprom24Lfs::erase(const struct lfs_config* c, lfs_block_t block)
+{
+	(void)c;
+	(void)block;
+	return LFS_ERR_OK;
+}
+
+
+/** Waits for the last write cycle, so that the data is in the memory when littlefs considers it synced.
+ *
+ */
+int Eeprom24Lfs::sync(const struct lfs_config* c)
+{
+	Eeprom24Lfs* device = static_cast<Eeprom24Lfs*>(c->context);
+
+	if (device->m_eeprom.isWritePending() && !device->m_eeprom.waitForReady())
+		return LFS_ERR_IO;
+	return LFS_ERR_OK;
+}
@@ -0,0 +1,59 @@
+/* eeprom24_lfs.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_LFS_H_
+#define EEPROM24_LFS_H_
+
+//littlefs (v2) is not part of this library: the application provides lfs.h on the include path and builds lfs.c
+#include "lfs.h"
+#include "eeprom24.h"
+
+/** littlefs block device on a region of an Eeprom24. The geometry follows the memory: prog_size and cache_size are one
+ *  page, so every prog is a single page-aligned page write; reads go straight to Eeprom24::read(), so file data larger
+ *  than the cache is read in one sequential transfer. EEPROM cells need no erasing, erase is a no-op.
+ *
+ *  Writes are pipelined: prog returns as soon as the page is sent, the write cycle runs while littlefs prepares the next
+ *  one and is only waited for by the next access, or by sync. The buffers littlefs works in are members of the
+ *  adapter, so it needs no heap.
+ *
+ *  	Eeprom24Lfs device(eeprom, 0x0000, 65536);
+ *  	lfs_t lfs;
+ *  	if (lfs_mount(&lfs, device.getConfig()) != LFS_ERR_OK)
+ *  		...
+ */
+class Eeprom24Lfs
+{
+public:
+	Eeprom24Lfs(Eeprom24& eeprom, uint32_t address, uint32_t size, uint16_t blockSize = DEFAULT_BLOCK_SIZE);
+
+	const struct lfs_config* getConfig(void) const {return &m_config;};
+
+	uint32_t getProgs(void) const {return m_progs;};
+	uint32_t getReads(void) const {return m_reads;};
+
+	static constexpr uint16_t DEFAULT_BLOCK_SIZE = 512;
+	static constexpr int32_t BLOCK_CYCLES = 500;
+
+protected:
+	static int read(const struct lfs_config* c, lfs_block_t block, lfs_off_t off, void* buffer, lfs_size_t size);
+	static int prog(const struct lfs_config* c, lfs_block_t block, lfs_off_t off, const void* buffer, lfs_size_t size);
+	static int erase(const struct lfs_config* c, lfs_block_t block);
+	static int sync(const struct lfs_config* c);
+
+	uint32_t getAddress(lfs_block_t block, lfs_off_t off) const {return m_address + block * m_config.block_size + off;};
+
+	Eeprom24& m_eeprom;
+	const uint32_t m_address;
+	struct lfs_config m_config;
+
+	uint8_t m_readBuffer[EEPROM24_MAX_PAGE_SIZE];
+	uint8_t m_progBuffer[EEPROM24_MAX_PAGE_SIZE];
+	alignas(4) uint8_t m_lookaheadBuffer[EEPROM24_MAX_PAGE_SIZE];
+
+	uint32_t m_progs = 0;
+	uint32_t m_reads = 0;
+};
+
+#endif /* EEPROM24_LFS_H_ */
@@ -0,0 +1,302 @@
+/* eeprom24_lz.cpp
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#include <string.h>
+#include "eeprom24_lz.h"
+
+
+Eeprom24LzWriter::Eeprom24LzWriter(Eeprom24& eeprom, uint32_t address, uint32_t capacity):
+	m_eeprom(eeprom), m_address(address), m_capacity(capacity), m_bufferAddress(address)
+{
+	//blank header, filled in by finish()
+	memset(m_buffer, 0xFF, HEADER_SIZE);
+	m_bufferCount = HEADER_SIZE;
+}
+
+
+/** Compresses data and appends it to the blob; full pages are written as they fill up.
+ *
+ * @param data			Pointer to data to compress.
+ * @param length		Number of bytes.
+ * @return				False if the blob doesn't fit its capacity or a write failed.
+ */
+bool Eeprom24LzWriter::write(const uint8_t* data, uint32_t length)
+{
+	for (uint32_t i = 0; i < length && !m_failed; i++)
+	{
+		m_lookahead[m_lookaheadCount++] = data[i];
+		m_rawSize++;
+
+		if (m_lookaheadCount == MAX_MATCH)
+			encodeToken();
+	}
+
+	return !m_failed;
+}
+
+
+/** Compresses the rest of the data, writes the last page and the header.
+ *
+ * @return				True if the whole blob was written.
+ */
+bool Eeprom24LzWriter::finish(void)
+{
+	while (m_lookaheadCount > 0 && !m_failed)
+		encodeToken();
+
+	if (m_bitCount > 0)
+		putBits(0, 8 - m_bitCount);
+	if (m_failed)
+		return false;
+
+	Header header = {m_rawSize, m_packedSize};
+
+	//a blob within the first page is written with its header at once
+	if (m_bufferAddress == m_address)
+	{
+		memcpy(m_buffer, &header, HEADER_SIZE);
+		return flushBuffer();
+	}
+
+	return flushBuffer() && m_eeprom.write(m_address, reinterpret_cast<const uint8_t*>(&header), HEADER_SIZE);
+}
+
+
+/** Encodes the longest match of the lookahead in the window, or a literal if there is none.
+ *
+ */
+bool Eeprom24LzWriter::encodeToken(void)
+{
+	uint16_t bestDistance = 0;
+	uint16_t bestLength = 0;
+
+	for (uint16_t distance = 1; distance <= m_historyCount && bestLength < m_lookaheadCount; distance++)
+	{
+		uint16_t length = 0;
+		while (length < m_lookaheadCount && getByte(distance, length) == m_lookahead[length])
+			length++;
+
+		if (length > bestLength)
+		{
+			bestLength = length;
+			bestDistance = distance;
+		}
+	}
+
+	if (bestLength >= MIN_MATCH)
+	{
+		putBits(0, 1);
+		putBits(bestDistance - 1, EEPROM24_LZ_WINDOW_BITS);
+		putBits(bestLength - MIN_MATCH, EEPROM24_LZ_LENGTH_BITS);
+	}
+	else
+	{
+		bestLength = 1;
+		putBits(1, 1);
+		putBits(m_lookahead[0], 8);
+	}
+
+	for (uint16_t i = 0; i < bestLength; i++)
+	{
+		m_history[m_historyHead] = m_lookahead[i];
+		m_historyHead = (m_historyHead + 1) % WINDOW_SIZE;
+	}
+	if (m_historyCount < WINDOW_SIZE)
+		m_historyCount = (m_historyCount + bestLength > WINDOW_SIZE) ? WINDOW_SIZE : m_historyCount + bestLength;
+
+	m_lookaheadCount -= bestLength;
+	memmove(m_lookahead, m_lookahead + bestLength, m_lookaheadCount);
+	return !m_failed;
+}
+
+
+/** Byte of a match candidate; a match may run on into the lookahead, as the decoder copies byte by byte.
+ *
+ * @param distance		Distance of the match start back from the lookahead.
+ * @param index			Index within the match.
+ */
+uint8_t Eeprom24LzWriter::getByte(uint16_t distance, uint16_t index) const
+{
+	int32_t position = (int32_t)index - (int32_t)distance;
+	if (position >= 0)
+		return m_lookahead[position];
+
+	return m_history[(m_historyHead + WINDOW_SIZE + position) % WINDOW_SIZE];
+}
+
+
+bool Eeprom24LzWriter::putBits(uint32_t value, uint8_t count)
+{
+	while (count > 0)
+	{
+		count--;
+		m_bits = (m_bits << 1) | ((value >> count) & 1);
+		m_bitCount++;
+
+		if (m_bitCount == 8)
+		{
+			putByte(m_bits);
+			m_bits = 0;
+			m_bitCount = 0;
+		}
+	}
+	return !m_failed;
+}
+
+
+bool Eeprom24LzWriter::putByte(uint8_t value)
+{
+	if (m_failed || HEADER_SIZE + m_packedSize >= m_capacity)
+	{
+		m_failed = true;
+		return false;
+	}
+
+	m_buffer[m_bufferCount++] = value;
+	m_packedSize++;
+
+	uint16_t pageSize = m_eeprom.getPageSizeInBytes();
+	if (pageSize > EEPROM24_MAX_PAGE_SIZE)
+		pageSize = EEPROM24_MAX_PAGE_SIZE;
+
+	//the blank header alone may already reach past the first page boundary, so that flush spans two pages
+	if (m_bufferCount >= pageSize - (m_bufferAddress % pageSize) && !flushBuffer())
+		m_failed = true;
+	return !m_failed;
+}
+
+
+/** Writes the page buffer; it always ends at a page boundary or at the end of the blob.
+ *
+ */
+bool Eeprom24LzWriter::flushBuffer(void)
+{
+	if (m_bufferCount == 0)
+		return true;
+
+	if (!m_eeprom.write(m_bufferAddress, m_buffer, m_bufferCount))
+		return false;
+
+	uint16_t pageSize = m_eeprom.getPageSizeInBytes();
+	m_pageWrites += (m_bufferAddress + m_bufferCount - 1) / pageSize - m_bufferAddress / pageSize + 1;
+	m_bufferAddress += m_bufferCount;
+	m_bufferCount = 0;
+	return true;
+}
+
+
+/** Reads the header and prepares decompression from the start of the blob.
+ *
+ * @return				False if there is no complete blob at the address.
+ */
+bool Eeprom24LzReader::open(void)
+{
+	if (!m_eeprom.read(m_address, reinterpret_cast<uint8_t*>(&m_header), HEADER_SIZE))
+		return false;
+
+	if (m_header.rawSize == 0xFFFFFFFF || m_header.packedSize > m_eeprom.getSizeInBytes())
+		return false;
+
+	m_historyHead = 0;
+	m_inputPosition = 0;
+	m_inputCount = 0;
+	m_inputAddress = m_address + HEADER_SIZE;
+	m_bitCount = 0;
+	m_rawRemaining = m_header.rawSize;
+	m_copyRemaining = 0;
+	return true;
+}
+
+
+/** Decompresses the next part of the blob.
+ *
+ * @param data			Array receiving the data.
+ * @param length		Number of bytes wanted.
+ * @return				Number of bytes produced; less than length at the end of the blob or on a read error.
+ */
+uint32_t Eeprom24LzReader::read(uint8_t* data, uint32_t length)
+{
+	uint32_t produced = 0;
+
+	while (produced < length && m_rawRemaining > 0)
+	{
+		if (m_copyRemaining == 0)
+		{
+			uint32_t flag, value;
+			if (!getBits(1, &flag))
+				break;
+
+			if (flag)
+			{
+				if (!getBits(8, &value))
+					break;
+				m_copyDistance = 0;
+				m_copyRemaining = 1;
+				putHistory(value);
+			}
+			else
+			{
+				uint32_t count;
+				if (!getBits(EEPROM24_LZ_WINDOW_BITS, &value) || !getBits(EEPROM24_LZ_LENGTH_BITS, &count))
+					break;
+				m_copyDistance = value + 1;
+				m_copyRemaining = count + MIN_MATCH;
+			}
+		}
+
+		//a literal was already put into the history, so it is copied from distance 1
+		uint16_t distance = m_copyDistance ? m_copyDistance : 1;
+		uint8_t value = m_history[(m_historyHead + WINDOW_SIZE - distance) % WINDOW_SIZE];
+		if (m_copyDistance)
+			putHistory(value);
+
+		data[produced++] = value;
+		m_copyRemaining--;
+		m_rawRemaining--;
+	}
+
+	return produced;
+}
+
+
+bool Eeprom24LzReader::getBits(uint8_t count, uint32_t* value)
+{
+	*value = 0;
+
+	while (count > 0)
+	{
+		if (m_bitCount == 0)
+		{
+			if (m_inputPosition == m_inputCount)
+			{
+				uint32_t end = m_address + HEADER_SIZE + m_header.packedSize;
+				if (m_inputAddress >= end)
+					return false;
+
+				m_inputCount = (end - m_inputAddress > INPUT_SIZE) ? INPUT_SIZE : end - m_inputAddress;
+				if (!m_eeprom.read(m_inputAddress, m_input, m_inputCount))
+					return false;
+				m_inputAddress += m_inputCount;
+				m_inputPosition = 0;
+			}
+
+			m_bits = m_input[m_inputPosition++];
+			m_bitCount = 8;
+		}
+
+		m_bitCount--;
+		*value = (*value << 1) | ((m_bits >> m_bitCount) & 1);
+		count--;
+	}
+
+	return true;
+}
+
+
+void Eeprom24LzReader::putHistory(uint8_t value)
+{
+	m_history[m_historyHead] = value;
+	m_historyHead = (m_historyHead + 1) % WINDOW_SIZE;
+}
@@ -0,0 +1,117 @@
+/* eeprom24_lz.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_LZ_H_
+#define EEPROM24_LZ_H_
+
+#include "eeprom24.h"
+
+/** Streaming LZSS compression of blobs, in the style of heatshrink: the output is a bit stream of literals
+ *  (flag 1 + 8 bits) and back-references into the last 2^EEPROM24_LZ_WINDOW_BITS bytes (flag 0 + distance + length).
+ *  Both sides need only the window in RAM, the writer additionally a page buffer, so blobs of any size are streamed.
+ *
+ *  A blob starts with a header holding the raw and the packed size. The header is written as blank with the first
+ *  page and filled in by finish(), so a blob interrupted while being saved doesn't open.
+ */
+class Eeprom24Lz
+{
+	static_assert(EEPROM24_LZ_WINDOW_BITS >= 1 && EEPROM24_LZ_WINDOW_BITS <= 15, "EEPROM24_LZ_WINDOW_BITS must be 1 to 15");
+	static_assert(EEPROM24_LZ_LENGTH_BITS >= 1 && EEPROM24_LZ_LENGTH_BITS <= 15, "EEPROM24_LZ_LENGTH_BITS must be 1 to 15");
+
+public:
+	struct Header
+	{
+		uint32_t rawSize;		///< 0xFFFFFFFF while the blob is being written
+		uint32_t packedSize;
+	};
+
+	static constexpr uint16_t WINDOW_SIZE = 1 << EEPROM24_LZ_WINDOW_BITS;
+	static constexpr uint8_t MIN_MATCH = 2;
+	static constexpr uint16_t MAX_MATCH = (1 << EEPROM24_LZ_LENGTH_BITS) + MIN_MATCH - 1;
+	static constexpr uint8_t HEADER_SIZE = sizeof(Header);
+};
+
+
+/** Compresses a blob into the memory as it is written. */
+class Eeprom24LzWriter: public Eeprom24Lz
+{
+public:
+	Eeprom24LzWriter(Eeprom24& eeprom, uint32_t address, uint32_t capacity);
+
+	bool write(const uint8_t* data, uint32_t length);
+	bool finish(void);
+
+	uint32_t getRawSize(void) const {return m_rawSize;};
+	uint32_t getPackedSize(void) const {return m_packedSize;};
+	uint32_t getPageWrites(void) const {return m_pageWrites;};
+
+protected:
+	bool encodeToken(void);
+	uint8_t getByte(uint16_t distance, uint16_t index) const;
+	bool putBits(uint32_t value, uint8_t count);
+	bool putByte(uint8_t value);
+	bool flushBuffer(void);
+
+	Eeprom24& m_eeprom;
+	const uint32_t m_address;
+	const uint32_t m_capacity;
+
+	uint8_t m_history[WINDOW_SIZE];
+	uint16_t m_historyHead = 0;
+	uint16_t m_historyCount = 0;
+	uint8_t m_lookahead[MAX_MATCH];
+	uint16_t m_lookaheadCount = 0;
+
+	uint8_t m_buffer[EEPROM24_MAX_PAGE_SIZE];
+	uint32_t m_bufferAddress;
+	uint16_t m_bufferCount = 0;
+	uint32_t m_bits = 0;
+	uint8_t m_bitCount = 0;
+
+	uint32_t m_rawSize = 0;
+	uint32_t m_packedSize = 0;
+	uint32_t m_pageWrites = 0;
+	bool m_failed = false;
+};
+
+
+/** Decompresses a blob from the memory in pieces of any size. */
+class Eeprom24LzReader: public Eeprom24Lz
+{
+public:
+	Eeprom24LzReader(Eeprom24& eeprom, uint32_t address): m_eeprom(eeprom), m_address(address) {};
+
+	bool open(void);
+	uint32_t read(uint8_t* data, uint32_t length);
+
+	uint32_t getRawSize(void) const {return m_header.rawSize;};
+	uint32_t getPackedSize(void) const {return m_header.packedSize;};
+
+protected:
+	bool getBits(uint8_t count, uint32_t* value);
+	void putHistory(uint8_t value);
+
+	static constexpr uint8_t INPUT_SIZE = 32;
+
+	Eeprom24& m_eeprom;
+	const uint32_t m_address;
+	Header m_header = {0, 0};
+
+	uint8_t m_history[WINDOW_SIZE];
+	uint16_t m_historyHead = 0;
+
+	uint8_t m_input[INPUT_SIZE];
+	uint8_t m_inputPosition = 0;
+	uint8_t m_inputCount = 0;
+	uint32_t m_inputAddress = 0;
+	uint32_t m_bits = 0;
+	uint8_t m_bitCount = 0;
+
+	uint32_t m_rawRemaining = 0;
+	uint16_t m_copyDistance = 0;
+	uint16_t m_copyRemaining = 0;
+};
+
+#endif /* EEPROM24_LZ_H_ */
@@ -0,0 +1,211 @@
+/* eeprom24_os.cpp
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#include "eeprom24_os.h"
+
+#if EEPROM24_OS == EEPROM24_OS_PTHREAD
+#include <time.h>
+#endif
+
+#if EEPROM24_OS == EEPROM24_OS_FREERTOS && EEPROM24_NOTIFY_INDEX >= configTASK_NOTIFICATION_ARRAY_ENTRIES
+#error "EEPROM24_NOTIFY_INDEX needs configTASK_NOTIFICATION_ARRAY_ENTRIES > EEPROM24_NOTIFY_INDEX"
+#endif
+
+namespace Eeprom24Os
+{
+
+#if EEPROM24_OS == EEPROM24_OS_FREERTOS
+
+/** Blocks the calling task, letting other tasks run; rounded up to whole ticks.
+ *
+ * @param us			Delay in us.
+ */
+void delayUs(uint32_t us)
+{
+	TickType_t ticks = ((uint64_t)us * configTICK_RATE_HZ + 999999) / 1000000;
+	vTaskDelay(ticks ? ticks : 1);
+}
+
+Mutex::Mutex()
+{
+	m_handle = xSemaphoreCreateMutexStatic(&m_storage);
+}
+
+void Mutex::lock(void)
+{
+	xSemaphoreTake(m_handle, portMAX_DELAY);
+}
+
+void Mutex::unlock(void)
+{
+	xSemaphoreGive(m_handle);
+}
+
+Signal::Signal()
+{
+}
+
+/** Registers the calling task as the one to be notified.
+ *
+ */
+void Signal::prepare(void)
+{
+	ulTaskNotifyTakeIndexed(EEPROM24_NOTIFY_INDEX, pdTRUE, 0);
+	m_waiter = xTaskGetCurrentTaskHandle();
+}
+
+/** Blocks on the task notification at EEPROM24_NOTIFY_INDEX until the signal is raised.
+ *
+ * @param timeout		Timeout in ms.
+ * @return				True if the signal was raised before timeout.
+ */
+bool Signal::wait(uint32_t timeout)
+{
+	bool raised = (ulTaskNotifyTakeIndexed(EEPROM24_NOTIFY_INDEX, pdTRUE, pdMS_TO_TICKS(timeout)) != 0);
+	m_waiter = nullptr;
+	return raised;
+}
+
+void Signal::raiseFromIsr(void)
+{
+	TaskHandle_t waiter = m_waiter;
+	if (waiter == nullptr)
+		return;
+
+	BaseType_t woken = pdFALSE;
+	vTaskNotifyGiveIndexedFromISR(waiter, EEPROM24_NOTIFY_INDEX, &woken);
+	portYIELD_FROM_ISR(woken);
+}
+
+#elif EEPROM24_OS == EEPROM24_OS_PTHREAD
+
+void delayUs(uint32_t us)
+{
+	struct timespec ts = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000};
+	nanosleep(&ts, nullptr);
+}
+
+Mutex::Mutex()
+{
+	pthread_mutex_init(&m_handle, nullptr);
+}
+
+void Mutex::lock(void)
+{
+	pthread_mutex_lock(&m_handle);
+}
+
+void Mutex::unlock(void)
+{
+	pthread_mutex_unlock(&m_handle);
+}
+
+Signal::Signal()
+{
+	pthread_mutex_init(&m_mutex, nullptr);
+	pthread_cond_init(&m_cond, nullptr);
+}
+
+void Signal::prepare(void)
+{
+	pthread_mutex_lock(&m_mutex);
+	m_raised = false;
+	pthread_mutex_unlock(&m_mutex);
+}
+
+/** Waits on the condition variable until the signal is raised.
+ *
+ * @param timeout		Timeout in ms.
+ * @return				True if the signal was raised before timeout.
+ */
+bool Signal::wait(uint32_t timeout)
+{
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += timeout / 1000;
+	deadline.tv_nsec += (long)(timeout % 1000) * 1000000;
+	if (deadline.tv_nsec >= 1000000000)
+	{
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000;
+	}
+
+	pthread_mutex_lock(&m_mutex);
+	while (!m_raised)
+	{
+		if (pthread_cond_timedwait(&m_cond, &m_mutex, &deadline) != 0)
+			break;
+	}
+	bool raised = m_raised;
+	pthread_mutex_unlock(&m_mutex);
+	return raised;
+}
+
+void Signal::raiseFromIsr(void)
+{
+	pthread_mutex_lock(&m_mutex);
+	m_raised = true;
+	pthread_cond_signal(&m_cond);
+	pthread_mutex_unlock(&m_mutex);
+}
+
+#else
+
+/** Waits at most the given time, rounded down to whole ms. HAL_Delay() waits one tick more than asked for, to get at
+ *  least a full tick, so it gets one less; shorter delays return straight away.
+ *
+ * @param us			Delay in us.
+ */
+void delayUs(uint32_t us)
+{
+	if (us >= 1000)
+		HAL_Delay(us / 1000 - 1);
+}
+
+Mutex::Mutex()
+{
+}
+
+void Mutex::lock(void)
+{
+}
+
+void Mutex::unlock(void)
+{
+}
+
+Signal::Signal()
+{
+}
+
+void Signal::prepare(void)
+{
+	m_raised = false;
+}
+
+/** Busy-waits for the signal; bare metal has nothing better to do.
+ *
+ * @param timeout		Timeout in ms.
+ * @return				True if the signal was raised before timeout.
+ */
+bool Signal::wait(uint32_t timeout)
+{
+	uint32_t start = HAL_GetTick();
+	while (!m_raised)
+	{
+		if (HAL_GetTick() - start > timeout)
+			return false;
+	}
+	return true;
+}
+
+void Signal::raiseFromIsr(void)
+{
+	m_raised = true;
+}
+
+#endif
+
+}
@@ -0,0 +1,74 @@
+/* eeprom24_os.h
+ *
+ * Created on: Oct 17, 2026
+ *
+ * Operating system adapter, selected by EEPROM24_OS: bare metal (default), FreeRTOS, or pthreads for host builds.
+ */
+
+#ifndef EEPROM24_OS_H_
+#define EEPROM24_OS_H_
+
+#include "hal_inc.h"
+#include "eeprom24_config.h"
+
+#if EEPROM24_OS == EEPROM24_OS_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#elif EEPROM24_OS == EEPROM24_OS_PTHREAD
+#include <pthread.h>
+#endif
+
+namespace Eeprom24Os
+{
+
+void delayUs(uint32_t us);
+
+/** Mutex guarding a shared bus; lockHook() and unlockHook() take the mutex as context, for Eeprom24Bus::setLock(). */
+class Mutex
+{
+public:
+	Mutex();
+
+	void lock(void);
+	void unlock(void);
+
+	static void lockHook(void* context) {static_cast<Mutex*>(context)->lock();};
+	static void unlockHook(void* context) {static_cast<Mutex*>(context)->unlock();};
+
+private:
+#if EEPROM24_OS == EEPROM24_OS_FREERTOS
+	StaticSemaphore_t m_storage;
+	SemaphoreHandle_t m_handle;
+#elif EEPROM24_OS == EEPROM24_OS_PTHREAD
+	pthread_mutex_t m_handle;
+#endif
+};
+
+/** One-shot completion signal, raised from an interrupt and waited for by a single task.
+ *  Call prepare() before starting the operation that will raise it.
+ */
+class Signal
+{
+public:
+	Signal();
+
+	void prepare(void);
+	bool wait(uint32_t timeout);
+	void raiseFromIsr(void);
+
+private:
+#if EEPROM24_OS == EEPROM24_OS_FREERTOS
+	TaskHandle_t volatile m_waiter = nullptr;
+#elif EEPROM24_OS == EEPROM24_OS_PTHREAD
+	pthread_mutex_t m_mutex;
+	pthread_cond_t m_cond;
+	bool m_raised = false;
+#else
+	volatile bool m_raised = false;
+#endif
+};
+
+}
+
+#endif /* EEPROM24_OS_H_ */
@@ -0,0 +1,159 @@
+/* eeprom24_partition.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_PARTITION_H_
+#define EEPROM24_PARTITION_H_
+
+#include <stddef.h>
+#include "eeprom24.h"
+#include "eeprom24_writeback.h"
+#include "eeprom24_readcache.h"
+#include "custom_assert.h"
+
+/** How a partition is accessed. */
+enum class Eeprom24Policy: uint8_t
+{
+	DIRECT,			///< plain Eeprom24 reads and writes
+	READ_ONLY,		///< writes don't compile
+	CACHED,			///< through an Eeprom24ReadCache; reads are served from RAM, writes go through to the memory
+	WRITE_BACK,		///< through an Eeprom24WriteBack, flushed according to its policy
+	EAGER_WRITE_BACK,	///< through an Eeprom24WriteBack, each write is followed by onIdle() to flush it early; reads
+						///< always go to the memory, merged with dirty lines
+	WEAR_LEVELED,	///< reserved for a rotating store (e.g. Eeprom24TimeSeries) that owns the range; can be listed in a
+					///< table, but a view of it doesn't compile, as random-access writes can't be wear leveled
+};
+
+/** One entry of a partition table; offset and size are in bytes. */
+struct Eeprom24Partition
+{
+	uint32_t offset;
+	uint32_t size;
+	Eeprom24Policy policy;
+
+	/** Checks a table for page alignment, overlaps and device bounds; meant for static_assert.
+	 *
+	 * @param table			Partition table.
+	 * @param pageSize		Page size of the memory; partitions must start and end at page boundaries.
+	 * @param deviceSize	Size of the memory in bytes.
+	 */
+	template<size_t N>
+	static constexpr bool validate(const Eeprom24Partition (&table)[N], uint16_t pageSize, uint32_t deviceSize)
+	{
+		for (size_t i = 0; i < N; i++)
+		{
+			const Eeprom24Partition& p = table[i];
+			if (p.size == 0 || p.offset % pageSize != 0 || p.size % pageSize != 0 || p.offset + p.size > deviceSize)
+				return false;
+
+			for (size_t j = i + 1; j < N; j++)
+			{
+				if (p.offset < table[j].offset + table[j].size && table[j].offset < p.offset + p.size)
+					return false;
+			}
+		}
+		return true;
+	};
+};
+
+/** Maps a policy to the class implementing it. */
+template<Eeprom24Policy P> struct Eeprom24PolicyBackend;
+template<> struct Eeprom24PolicyBackend<Eeprom24Policy::DIRECT> {using type = Eeprom24;};
+template<> struct Eeprom24PolicyBackend<Eeprom24Policy::READ_ONLY> {using type = Eeprom24;};
+template<> struct Eeprom24PolicyBackend<Eeprom24Policy::CACHED> {using type = Eeprom24ReadCache;};
+template<> struct Eeprom24PolicyBackend<Eeprom24Policy::WRITE_BACK> {using type = Eeprom24WriteBack;};
+template<> struct Eeprom24PolicyBackend<Eeprom24Policy::EAGER_WRITE_BACK> {using type = Eeprom24WriteBack;};
+template<> struct Eeprom24PolicyBackend<Eeprom24Policy::WEAR_LEVELED> {using type = Eeprom24;};	//rejected by the view
+
+
+/** Access to one partition of a compile-time layout. The layout is a type providing the table and the geometry it was
+ *  planned for; it is validated whenever a view is instantiated:
+ *
+ *  	struct Layout
+ *  	{
+ *  		static constexpr uint16_t pageSize = 128;
+ *  		static constexpr uint32_t deviceSize = 65536;
+ *  		static constexpr Eeprom24Partition partitions[] = {
+ *  			{0x0000, 0x0400, Eeprom24Policy::EAGER_WRITE_BACK},	//config
+ *  			{0x0400, 0xF400, Eeprom24Policy::WRITE_BACK},	//logs
+ *  			{0xF800, 0x0400, Eeprom24Policy::CACHED},		//lookup tables
+ *  			{0xFC00, 0x0400, Eeprom24Policy::READ_ONLY},	//calibration
+ *  		};
+ *  	};
+ *  	Eeprom24PartitionView<Layout, 2> calibration(eeprom);
+ *
+ *  Addresses are relative to the partition. Bounds checks of inlined calls with constant arguments fold away, and
+ *  put()/get() with a template address are checked at compile time. The constructor asserts that the memory behind
+ *  the backend has the geometry the layout was planned for.
+ *
+ * @tparam Layout		Layout type.
+ * @tparam Index		Index of the partition in Layout::partitions.
+ */
+template<typename Layout, size_t Index>
+class Eeprom24PartitionView
+{
+	static_assert(Eeprom24Partition::validate(Layout::partitions, Layout::pageSize, Layout::deviceSize),
+		"Partitions must be page aligned, must not overlap and must fit the memory");
+	static_assert(Index < sizeof(Layout::partitions) / sizeof(Eeprom24Partition), "No such partition");
+	static_assert(Layout::partitions[Index].policy != Eeprom24Policy::WEAR_LEVELED,
+		"Wear-leveled partitions have no view; pass the range to the rotating store that owns it");
+
+public:
+	static constexpr uint32_t offset = Layout::partitions[Index].offset;
+	static constexpr uint32_t size = Layout::partitions[Index].size;
+	static constexpr Eeprom24Policy policy = Layout::partitions[Index].policy;
+	using Backend = typename Eeprom24PolicyBackend<policy>::type;
+
+	Eeprom24PartitionView(Backend& backend): m_backend(backend)
+	{
+		assert(getEeprom(backend).getPageSizeInBytes() == Layout::pageSize);
+		assert(getEeprom(backend).getSizeInBytes() == Layout::deviceSize);
+	};
+
+	bool write(uint32_t address, const uint8_t* data, uint32_t length)
+	{
+		static_assert(policy != Eeprom24Policy::READ_ONLY, "Partition is read-only");
+
+		if (address >= size || length > size - address)
+			return false;
+
+		bool retval = m_backend.write(offset + address, data, length);
+		if constexpr (policy == Eeprom24Policy::EAGER_WRITE_BACK)
+			m_backend.onIdle();
+		return retval;
+	};
+
+	bool read(uint32_t address, uint8_t* data, uint32_t length)
+	{
+		if (address >= size || length > size - address)
+			return false;
+
+		return m_backend.read(offset + address, data, length);
+	};
+
+	template<uint32_t Address, typename T>
+	bool put(const T& value)
+	{
+		static_assert(Address + sizeof(T) <= size, "Access out of partition bounds");
+		return write(Address, reinterpret_cast<const uint8_t*>(&value), sizeof(T));
+	};
+
+	template<uint32_t Address, typename T>
+	bool get(T& value)
+	{
+		static_assert(Address + sizeof(T) <= size, "Access out of partition bounds");
+		return read(Address, reinterpret_cast<uint8_t*>(&value), sizeof(T));
+	};
+
+	Backend& getBackend(void) {return m_backend;};
+
+private:
+	static const Eeprom24& getEeprom(const Eeprom24& eeprom) {return eeprom;};
+	static const Eeprom24& getEeprom(const Eeprom24WriteBack& cache) {return cache.getEeprom();};
+	static const Eeprom24& getEeprom(const Eeprom24ReadCache& cache) {return cache.getEeprom();};
+
+	Backend& m_backend;
+};
+
+#endif /* EEPROM24_PARTITION_H_ */
@@ -0,0 +1,271 @@
+/* eeprom24_persistent.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_PERSISTENT_H_
+#define EEPROM24_PERSISTENT_H_
+
+#include <type_traits>
+#include <stddef.h>
+#include <string.h>
+#include "eeprom24.h"
+#include "custom_assert.h"
+
+/** A field of a Persistent struct, with its offset known at compile time; declare it with EEPROM24_MEMBER(). */
+template<typename F, uint32_t Offset>
+struct PersistentField
+{
+	using type = F;
+	static constexpr uint32_t offset = Offset;
+};
+
+#define EEPROM24_MEMBER(T, member)		PersistentField<decltype(T::member), offsetof(T, member)>
+
+/** A struct stored at a fixed EEPROM address. The layout is known at compile time, so field setters write just the
+ *  bytes of that field (split along page boundaries by Eeprom24::write()) instead of the whole struct. Reads are
+ *  served from a RAM copy once the struct has been loaded; the copy only changes once a write has succeeded.
+ *
+ *  Usage:
+ *  	using Gain = EEPROM24_MEMBER(Settings, gain);
+ *  	using StoredSettings = Persistent<Settings, 0x0100>;
+ *  	static_assert(StoredSettings::addressOf<Gain>() % 4 == 0, "gain must not straddle a 4 byte boundary");
+ *
+ *  	StoredSettings settings(eeprom);
+ *  	settings.set<Gain>(1.5f);
+ *
+ * @tparam T			Trivially copyable, standard layout struct.
+ * @tparam Address		EEPROM address of the struct.
+ */
+template<typename T, uint32_t Address>
+class Persistent
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Persistent types must be trivially copyable");
+	static_assert(std::is_standard_layout<T>::value, "Persistent types must have a standard layout");
+
+public:
+	static constexpr uint32_t address = Address;
+	static constexpr uint32_t size = sizeof(T);
+	static constexpr uint32_t endAddress = Address + sizeof(T);
+
+	/** Number of pages touched by the whole struct, for a given page size. */
+	static constexpr uint32_t pagesSpanned(uint16_t pageSize) {return (endAddress - 1) / pageSize - Address / pageSize + 1;};
+
+	/** EEPROM address of a field. */
+	template<typename Field>
+	static constexpr uint32_t addressOf(void)
+	{
+		static_assert(Field::offset + sizeof(typename Field::type) <= sizeof(T), "Field is not a member of the struct");
+		return Address + Field::offset;
+	};
+
+	/** The struct must fit the memory; checked when the object is bound to it. */
+	Persistent(Eeprom24& eeprom): m_eeprom(eeprom)
+	{
+		assert(endAddress <= eeprom.getSizeInBytes());
+	};
+
+	bool load(void)
+	{
+		m_cached = m_eeprom.read(Address, reinterpret_cast<uint8_t*>(&m_value), sizeof(T));
+		return m_cached;
+	};
+
+	/** Rewrites the cached struct. Fails without writing if nothing has been loaded or saved yet, as the cache would
+	 *  only hold a default-constructed T.
+	 *
+	 * @return				True if write operation was successful.
+	 */
+	bool save(void)
+	{
+		if (!m_cached)
+			return false;
+
+		return m_eeprom.write(Address, reinterpret_cast<const uint8_t*>(&m_value), sizeof(T));
+	};
+
+	bool save(const T& value)
+	{
+		if (!m_eeprom.write(Address, reinterpret_cast<const uint8_t*>(&value), sizeof(T)))
+			return false;
+
+		m_value = value;
+		m_cached = true;
+		return true;
+	};
+
+	/** Returns the cached struct, loading it first if needed. */
+	const T& get(void)
+	{
+		if (!m_cached)
+			load();
+		return m_value;
+	};
+
+	/** Returns a field from the cache, loading the struct first if needed. */
+	template<typename Field>
+	const typename Field::type& get(void)
+	{
+		get();
+		return *reinterpret_cast<const typename Field::type*>(reinterpret_cast<const uint8_t*>(&m_value) + Field::offset);
+	};
+
+	/** Writes a single field; only sizeof(field) bytes go to the memory, and nothing at all if the value is unchanged.
+	 *
+	 * @return				True if write operation was successful.
+	 */
+	template<typename Field>
+	bool set(const typename Field::type& value)
+	{
+		uint8_t* field = reinterpret_cast<uint8_t*>(&m_value) + Field::offset;
+
+		if (m_cached && memcmp(field, &value, sizeof(value)) == 0)
+			return true;
+
+		if (!m_eeprom.write(addressOf<Field>(), reinterpret_cast<const uint8_t*>(&value), sizeof(value)))
+			return false;
+
+		memcpy(field, &value, sizeof(value));
+		return true;
+	};
+
+private:
+	Eeprom24& m_eeprom;
+	T m_value {};
+	bool m_cached = false;
+};
+
+
+/** A struct at a runtime address that remembers what was last saved. save() diffs the struct against that image a word
+ *  at a time and writes only the changed runs. Runs within one page are merged into a single page write when resending
+ *  the unchanged bytes between them is cheaper than another write cycle.
+ *
+ * @tparam T			Trivially copyable struct.
+ */
+template<typename T>
+class PersistentObject
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Persistent types must be trivially copyable");
+
+public:
+	PersistentObject(Eeprom24& eeprom, uint32_t address): m_eeprom(eeprom), m_address(address) {};
+
+	/** Loads the struct from the memory; the loaded content becomes the last saved image. */
+	bool load(void)
+	{
+		m_imageValid = m_eeprom.read(m_address, m_image, sizeof(T));
+		if (m_imageValid)
+			memcpy(&m_value, m_image, sizeof(T));
+		return m_imageValid;
+	};
+
+	bool save(void);
+
+	T& value(void) {return m_value;};
+	T* operator->(void) {return &m_value;};
+
+	uint32_t getBytesWritten(void) const {return m_bytesWritten;};
+	uint32_t getPageWrites(void) const {return m_pageWrites;};
+	uint32_t getSaves(void) const {return m_saves;};
+
+private:
+	bool writeRun(uint32_t start, uint32_t end);
+
+	Eeprom24& m_eeprom;
+	const uint32_t m_address;
+	T m_value {};
+	uint8_t m_image[sizeof(T)];
+	bool m_imageValid = false;
+
+	uint32_t m_bytesWritten = 0;
+	uint32_t m_pageWrites = 0;
+	uint32_t m_saves = 0;
+};
+
+
+/** Writes the changes made since the last save (or load). Without a valid image, the whole struct is written.
+ *
+ * @return				True if all changes were written.
+ */
+template<typename T>
+bool PersistentObject<T>::save(void)
+{
+	m_saves++;
+
+	if (!m_imageValid)
+	{
+		m_imageValid = writeRun(0, sizeof(T));
+		return m_imageValid;
+	}
+
+	const uint8_t* current = reinterpret_cast<const uint8_t*>(&m_value);
+	const uint16_t pageSize = m_eeprom.getPageSizeInBytes();
+
+	//resending a gap is worth it while it takes less than the write cycle it saves
+	const uint32_t maxGap = m_eeprom.getWriteCycleEstimate(1) / EEPROM24_BYTE_TIME_US;
+
+	uint32_t runStart = 0, runEnd = 0;
+	bool inRun = false;
+	uint32_t i = 0;
+
+	while (i < sizeof(T))
+	{
+		//skip equal words quickly, then find the exact differing bytes
+		if (i % 4 == 0 && i + 4 <= sizeof(T))
+		{
+			uint32_t a, b;
+			memcpy(&a, current + i, 4);
+			memcpy(&b, m_image + i, 4);
+			if (a == b)
+			{
+				i += 4;
+				continue;
+			}
+		}
+
+		if (current[i] != m_image[i])
+		{
+			bool samePage = inRun && ((m_address + runStart) / pageSize == (m_address + i) / pageSize);
+			if (samePage && i - runEnd <= maxGap)
+				runEnd = i + 1;
+			else
+			{
+				if (inRun && !writeRun(runStart, runEnd))
+					return false;
+				runStart = i;
+				runEnd = i + 1;
+				inRun = true;
+			}
+		}
+
+		i++;
+	}
+
+	if (inRun && !writeRun(runStart, runEnd))
+		return false;
+
+	return true;
+}
+
+
+/** Writes a range of the struct and updates the image.
+ *
+ * @param start			Offset of the first byte within the struct.
+ * @param end			Offset past the last byte.
+ * @return				True if write operation was successful.
+ */
+template<typename T>
+bool PersistentObject<T>::writeRun(uint32_t start, uint32_t end)
+{
+	const uint8_t* current = reinterpret_cast<const uint8_t*>(&m_value);
+	if (!m_eeprom.write(m_address + start, current + start, end - start))
+		return false;
+
+	uint16_t pageSize = m_eeprom.getPageSizeInBytes();
+	m_pageWrites += (m_address + end - 1) / pageSize - (m_address + start) / pageSize + 1;
+	m_bytesWritten += end - start;
+	memcpy(m_image + start, current + start, end - start);
+	return true;
+}
+
+#endif /* EEPROM24_PERSISTENT_H_ */
@@ -0,0 +1,143 @@
+/* eeprom24_readcache.cpp
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#include <string.h>
+#include "eeprom24_readcache.h"
+
+
+Eeprom24ReadCache::Eeprom24ReadCache(Eeprom24& eeprom, Line* lines, uint8_t lineCount, uint16_t lineSize):
+	m_eeprom(eeprom), m_lines(lines), m_lineCount(lineCount),
+	m_lineSize(eeprom.getPageAlignedSize(lineSize))
+{
+}
+
+
+/** Reads data through the cache; missing lines are loaded from the memory whole.
+ *
+ * @param address		Address to start reading at.
+ * @param data			Pointer to an array in which data will be stored.
+ * @param length		How many bytes to read.
+ * @return				True if read was successful.
+ */
+bool Eeprom24ReadCache::read(uint32_t address, uint8_t* data, uint32_t length)
+{
+	if (address + length > m_eeprom.getSizeInBytes())
+		return false;
+
+	while (length > 0)
+	{
+		uint32_t index = address / m_lineSize;
+		uint16_t offset = address % m_lineSize;
+		uint16_t chunk = m_lineSize - offset;
+		if (chunk > length)
+			chunk = length;
+
+		Line* line = findLine(index);
+		if (line != nullptr)
+			m_hits++;
+		else
+		{
+			m_misses++;
+			line = loadLine(index);
+			if (line == nullptr)
+				return false;
+		}
+
+		line->lastUse = ++m_useCounter;
+		memcpy(data, &line->data[offset], chunk);
+
+		address += chunk;
+		data += chunk;
+		length -= chunk;
+	}
+
+	return true;
+}
+
+
+/** Writes data to the memory and to any cached lines it covers. Lines are only updated once the write succeeded; after
+ *  a failed write, their content is unknown and they are dropped.
+ *
+ * @param address		Address to start writing at.
+ * @param data			Pointer to an array with data to be written.
+ * @param length		How many bytes to write.
+ * @return				True if write operation was successful.
+ */
+bool Eeprom24ReadCache::write(uint32_t address, const uint8_t* data, uint32_t length)
+{
+	bool retval = m_eeprom.write(address, data, length);
+
+	for (uint8_t i = 0; i < m_lineCount; i++)
+	{
+		Line& line = m_lines[i];
+		uint32_t lineAddress = line.index * m_lineSize;
+		if (!line.valid || lineAddress >= address + length || lineAddress + m_lineSize <= address)
+			continue;
+
+		if (!retval)
+		{
+			line.valid = false;
+			continue;
+		}
+
+		uint32_t first = (address > lineAddress) ? address : lineAddress;
+		uint32_t end = (address + length < lineAddress + m_lineSize) ? address + length : lineAddress + m_lineSize;
+		memcpy(&line.data[first - lineAddress], data + (first - address), end - first);
+	}
+
+	return retval;
+}
+
+
+/** Drops all cached lines, e.g. after the memory was written around the cache. */
+void Eeprom24ReadCache::invalidate(void)
+{
+	for (uint8_t i = 0; i < m_lineCount; i++)
+		m_lines[i].valid = false;
+}
+
+
+Eeprom24ReadCache::Line* Eeprom24ReadCache::findLine(uint32_t index)
+{
+	for (uint8_t i = 0; i < m_lineCount; i++)
+	{
+		if (m_lines[i].valid && m_lines[i].index == index)
+			return &m_lines[i];
+	}
+	return nullptr;
+}
+
+
+/** Loads a line from the memory into a free line, or into the least recently used one.
+ *
+ * @param index			Line index (address / line size).
+ * @return				The loaded line, nullptr if the read failed.
+ */
+Eeprom24ReadCache::Line* Eeprom24ReadCache::loadLine(uint32_t index)
+{
+	Line* victim = nullptr;
+	for (uint8_t i = 0; i < m_lineCount; i++)
+	{
+		Line& line = m_lines[i];
+		if (!line.valid)
+		{
+			victim = &line;
+			break;
+		}
+		if (victim == nullptr || m_useCounter - line.lastUse > m_useCounter - victim->lastUse)
+			victim = &line;
+	}
+
+	if (victim == nullptr)
+		return nullptr;
+
+	victim->valid = false;
+	if (!m_eeprom.read(index * m_lineSize, victim->data, m_lineSize))
+		return nullptr;
+
+	victim->index = index;
+	victim->valid = true;
+	return victim;
+}
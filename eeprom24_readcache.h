@@ -0,0 +1,75 @@
+/* eeprom24_readcache.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_READCACHE_H_
+#define EEPROM24_READCACHE_H_
+
+#include "eeprom24.h"
+
+/** Write-through read cache over an Eeprom24. Reads are served from RAM lines, a miss loads the whole line and evicts
+ *  the least recently used one. Writes go to the memory straight away and update the cached copies once they succeed,
+ *  so the cache never holds data the memory doesn't.
+ *
+ *  Lines use the largest divisor of the EEPROM page size that fits the buffer line size, so a line never straddles a
+ *  page boundary. Use Eeprom24ReadCacheBuffer to get the storage.
+ */
+class Eeprom24ReadCache
+{
+public:
+	struct Line
+	{
+		uint8_t* data;
+		uint32_t index;
+		uint32_t lastUse;
+		bool valid;
+	};
+
+	Eeprom24ReadCache(Eeprom24& eeprom, Line* lines, uint8_t lineCount, uint16_t lineSize);
+
+	bool read(uint32_t address, uint8_t* data, uint32_t length);
+	bool write(uint32_t address, const uint8_t* data, uint32_t length);
+	void invalidate(void);
+
+	const Eeprom24& getEeprom(void) const {return m_eeprom;};
+	uint32_t getHits(void) const {return m_hits;};
+	uint32_t getMisses(void) const {return m_misses;};
+
+protected:
+	Line* findLine(uint32_t index);
+	Line* loadLine(uint32_t index);
+
+	Eeprom24& m_eeprom;
+	Line* const m_lines;
+	const uint8_t m_lineCount;
+	const uint16_t m_lineSize;
+
+	uint32_t m_useCounter = 0;
+	uint32_t m_hits = 0;
+	uint32_t m_misses = 0;
+};
+
+
+/** Read cache together with its storage.
+ *
+ * @tparam LineCount	Number of cache lines.
+ * @tparam LineSize		Bytes per line; rounded down to a divisor of the EEPROM's page size, so use one (e.g. a power
+ * 						of two) to not waste RAM.
+ */
+template<uint8_t LineCount, uint16_t LineSize>
+class Eeprom24ReadCacheBuffer: public Eeprom24ReadCache
+{
+public:
+	Eeprom24ReadCacheBuffer(Eeprom24& eeprom): Eeprom24ReadCache(eeprom, m_storage, LineCount, LineSize)
+	{
+		for (uint8_t i = 0; i < LineCount; i++)
+			m_storage[i] = {m_data[i], 0, 0, false};
+	};
+
+private:
+	Line m_storage[LineCount];
+	uint8_t m_data[LineCount][LineSize];
+};
+
+#endif /* EEPROM24_READCACHE_H_ */
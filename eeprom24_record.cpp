@@ -0,0 +1,201 @@
+/* eeprom24_record.cpp
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#include <string.h>
+#include "eeprom24_record.h"
+
+
+/** Reads the stored version before the record is shared, and repairs an odd one left by an update interrupted by a
+ *  reset: it is moved to the next even version. The data of such an update may be partly written.
+ *
+ * @param interrupted	Receives whether an interrupted update was repaired, may be null.
+ * @return				True if the version was read, and written if needed.
+ */
+bool Eeprom24Record::mount(bool* interrupted)
+{
+	uint8_t stored[HEADER_SIZE];
+	m_versionReads++;
+	m_mutex.lock();
+	bool ok = m_eeprom.read(m_address, stored, HEADER_SIZE);
+	uint32_t version = decodeVersion(stored);
+	bool odd = ok && isClaimed(version);
+
+	if (odd)
+		ok = writeVersion(++version);
+	m_mutex.unlock();
+
+	if (interrupted)
+		*interrupted = odd;
+	if (!ok)
+		return false;
+
+	m_version.store((version == UNKNOWN) ? 0 : version);
+	return true;
+}
+
+
+/** Reads the record and its version. A copy read while another task was updating the record is discarded and read
+ *  again, so the data always matches the version.
+ *
+ * @param data			Array receiving the record, size bytes.
+ * @param version		Receives the version to pass to compareAndSwap(); 0 for a record never written.
+ * @return				False if the read failed, the stored version is odd (see mount()), or no consistent copy was
+ * 						read within LOAD_RETRIES attempts.
+ */
+bool Eeprom24Record::load(void* data, uint32_t* version)
+{
+	for (uint8_t retry = 0; retry <= LOAD_RETRIES; retry++)
+	{
+		uint32_t before = m_version.load();
+		if (isClaimed(before))
+		{
+			EEPROM24_DELAY_US(EEPROM24_POLL_INTERVAL_US);
+			continue;
+		}
+
+		m_mutex.lock();
+		bool ok = readVersion(version) && m_eeprom.read(m_address + HEADER_SIZE, static_cast<uint8_t*>(data), m_size);
+		m_mutex.unlock();
+		if (!ok)
+			return false;
+
+		if (m_version.load() == before)
+		{
+			m_version.compare_exchange_strong(before, *version);
+			return true;
+		}
+	}
+	return false;
+}
+
+
+/** Writes the record if its version is still the expected one.
+ *
+ * @param expected		Version the new data is based on, as returned by load() or a previous compareAndSwap().
+ * @param data			New content of the record, size bytes.
+ * @param version		Receives the new version, may be null.
+ * @return				CAS_CONFLICT if the record was changed or is being changed by someone else; reload and retry.
+ */
+Eeprom24Record::Result Eeprom24Record::compareAndSwap(uint32_t expected, const void* data, uint32_t* version)
+{
+	uint32_t cached = m_version.load();
+
+	//only a record nobody has loaded yet needs its version read from the memory
+	if (cached == UNKNOWN)
+	{
+		uint32_t stored;
+		m_mutex.lock();
+		bool ok = readVersion(&stored);
+		m_mutex.unlock();
+		if (!ok)
+			return CAS_ERROR;
+
+		if (stored != expected)
+		{
+			m_version.compare_exchange_strong(cached, stored);
+			m_conflicts++;
+			return CAS_CONFLICT;
+		}
+	}
+	else if (cached != expected)
+	{
+		m_conflicts++;
+		return CAS_CONFLICT;
+	}
+
+	if (!m_version.compare_exchange_strong(cached, expected + 1))
+	{
+		m_conflicts++;
+		return CAS_CONFLICT;
+	}
+
+	//the odd version goes out with the data and the even one after it, so an interrupted update stays odd in the memory
+	uint32_t next = expected + 2;
+	m_mutex.lock();
+	bool ok = writeData(expected + 1, data) && writeVersion(next);
+	m_mutex.unlock();
+	if (!ok)
+	{
+		m_version.store(UNKNOWN);
+		return CAS_ERROR;
+	}
+
+	m_version.store(next);
+	m_updates++;
+	if (version)
+		*version = next;
+	return CAS_OK;
+}
+
+
+bool Eeprom24Record::readVersion(uint32_t* version)
+{
+	uint8_t stored[HEADER_SIZE];
+	m_versionReads++;
+	if (!m_eeprom.read(m_address, stored, HEADER_SIZE))
+		return false;
+
+	//blank memory is version 0; an odd version is an interrupted update, never cached
+	*version = decodeVersion(stored);
+	if (*version == UNKNOWN)
+		*version = 0;
+	return !(*version & 1);
+}
+
+
+/** Writes the version, most significant byte first: until the last byte is in, the stored version is the old one
+ *  with new upper bytes, and as that is odd when the new version is committed, a cut-short commit stays odd.
+ *
+ */
+bool Eeprom24Record::writeVersion(uint32_t version)
+{
+	uint8_t stored[HEADER_SIZE];
+	encodeVersion(version, stored);
+	return m_eeprom.write(m_address, stored, HEADER_SIZE);
+}
+
+
+/** Writes a version followed by the data. The header and the start of the data share the first write, so the data
+ *  takes no more page writes than it would alone; the rest is written straight from the caller's array.
+ *
+ */
+bool Eeprom24Record::writeData(uint32_t version, const void* data)
+{
+	uint16_t pageSize = m_eeprom.getPageSizeInBytes();
+	if (pageSize > EEPROM24_MAX_PAGE_SIZE)
+		pageSize = EEPROM24_MAX_PAGE_SIZE;
+
+	//up to the first page boundary, but at least the header
+	uint32_t head = pageSize - m_address % pageSize;
+	if (head < HEADER_SIZE)
+		head = HEADER_SIZE;
+	if (head > (uint32_t)HEADER_SIZE + m_size)
+		head = HEADER_SIZE + m_size;
+
+	uint8_t buffer[EEPROM24_MAX_PAGE_SIZE];
+	encodeVersion(version, buffer);
+	memcpy(buffer + HEADER_SIZE, data, head - HEADER_SIZE);
+	if (!m_eeprom.write(m_address, buffer, head))
+		return false;
+
+	uint32_t done = head - HEADER_SIZE;
+	return done == m_size || m_eeprom.write(m_address + head, static_cast<const uint8_t*>(data) + done, m_size - done);
+}
+
+
+void Eeprom24Record::encodeVersion(uint32_t version, uint8_t* stored)
+{
+	for (uint8_t i = 0; i < HEADER_SIZE; i++)
+		stored[i] = version >> (8 * (HEADER_SIZE - 1 - i));
+}
+
+
+uint32_t Eeprom24Record::decodeVersion(const uint8_t* stored)
+{
+	uint32_t version = 0;
+	for (uint8_t i = 0; i < HEADER_SIZE; i++)
+		version = (version << 8) | stored[i];
+	return version;
+}
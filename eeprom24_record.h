@@ -0,0 +1,73 @@
+/* eeprom24_record.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_RECORD_H_
+#define EEPROM24_RECORD_H_
+
+#include <atomic>
+#include "eeprom24.h"
+#include "eeprom24_os.h"
+
+/** A record shared by several tasks, updated with compare-and-swap instead of a mutex around read-modify-write. The
+ *  record starts with a version stamp that grows by 2 with every update; compareAndSwap() writes only if the stored
+ *  version is still the one the caller's data was based on, otherwise it fails and the caller reloads and retries.
+ *
+ *  The version is cached in RAM, so a conflict is usually detected without reading the memory. While an update is being
+ *  written the cached version is odd, which claims the record: a concurrent update fails at once instead of blocking,
+ *  and load() retries, up to LOAD_RETRIES times, until it gets a consistent copy. An update writes the odd version
+ *  together with the data, then the even one, so one interrupted by a reset leaves an odd version in the memory; it is
+ *  rejected until mount() has repaired it and reported the update as interrupted.
+ *
+ *  All tasks have to share the same Eeprom24Record object. The atomics only order the versions; each access to the
+ *  memory is made under the record's RTOS mutex, held for one read or one update and never across a read-modify-write,
+ *  and the transfers are serialized with the other devices by an Eeprom24Bus (setBus()). Thread safety therefore needs
+ *  an RTOS adapter (EEPROM24_OS) and the bus, and no task may use the same Eeprom24 directly while the record is
+ *  shared; on bare metal the record is for a single task.
+ */
+class Eeprom24Record
+{
+public:
+	enum Result: uint8_t
+	{
+		CAS_OK,
+		CAS_CONFLICT,
+		CAS_ERROR,
+	};
+
+	Eeprom24Record(Eeprom24& eeprom, uint32_t address, uint16_t size): m_eeprom(eeprom), m_address(address), m_size(size) {};
+
+	bool mount(bool* interrupted = nullptr);
+	bool load(void* data, uint32_t* version);
+	Result compareAndSwap(uint32_t expected, const void* data, uint32_t* version = nullptr);
+
+	uint32_t getVersion(void) const {return m_version.load();};
+	uint32_t getUpdates(void) const {return m_updates.load();};
+	uint32_t getConflicts(void) const {return m_conflicts.load();};
+	uint32_t getVersionReads(void) const {return m_versionReads.load();};
+
+	static constexpr uint32_t UNKNOWN = 0xFFFFFFFF;
+	static constexpr uint8_t HEADER_SIZE = sizeof(uint32_t);
+	static constexpr uint8_t LOAD_RETRIES = 50;
+
+protected:
+	bool readVersion(uint32_t* version);
+	bool writeVersion(uint32_t version);
+	bool writeData(uint32_t version, const void* data);
+	static void encodeVersion(uint32_t version, uint8_t* stored);
+	static uint32_t decodeVersion(const uint8_t* stored);
+	static bool isClaimed(uint32_t version) {return (version & 1) && version != UNKNOWN;};
+
+	Eeprom24& m_eeprom;
+	const uint32_t m_address;
+	const uint16_t m_size;
+	Eeprom24Os::Mutex m_mutex;
+
+	std::atomic<uint32_t> m_version {UNKNOWN};
+	std::atomic<uint32_t> m_updates {0};
+	std::atomic<uint32_t> m_conflicts {0};
+	std::atomic<uint32_t> m_versionReads {0};
+};
+
+#endif /* EEPROM24_RECORD_H_ */
@@ -0,0 +1,290 @@
+/* eeprom24_rrd.cpp
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#include <math.h>
+#include <string.h>
+#include "eeprom24_rrd.h"
+#include "eeprom24_crc.h"
+
+
+/** Restores per-tier progress from the header; without a valid header, the first update() starts from scratch. A
+ *  header written for a different tier layout means the slots hold data of another layout, so the store is formatted.
+ *
+ * @return				True if the header could be read, and the store formatted if needed.
+ */
+bool Eeprom24Rrd::mount(void)
+{
+	uint32_t header[HEADER_WORDS + m_tierCount];
+	if (!m_eeprom.read(m_headerAddress, reinterpret_cast<uint8_t*>(header), sizeof(header)))
+		return false;
+
+	m_started = false;
+	if (header[0] != MAGIC)
+		return true;
+	if (header[1] != getLayoutSignature())
+		return format();
+
+	m_started = true;
+	for (uint8_t i = 0; i < m_tierCount; i++)
+	{
+		Tier& tier = m_tiers[i];
+		tier.interval = header[HEADER_WORDS + i];
+		tier.pendingStart = header[HEADER_WORDS + i];
+		tier.pendingCount = 0;
+		tier.samples = 0;
+	}
+
+	return true;
+}
+
+
+/** Erases all tiers to NaN and invalidates the header; the first update() starts from scratch. Takes a page write
+ *  per page of every tier.
+ *
+ * @return				True if write operation was successful.
+ */
+bool Eeprom24Rrd::format(void)
+{
+	uint8_t blank[EEPROM24_MAX_PAGE_SIZE];
+	memset(blank, 0xFF, m_pageSize);
+
+	//the header goes first, so that an interrupted format isn't mounted with the old progress
+	if (!m_eeprom.write(m_headerAddress, blank, sizeof(uint32_t)))
+		return false;
+
+	for (uint8_t i = 0; i < m_tierCount; i++)
+	{
+		const Tier& tier = m_tiers[i];
+		for (uint32_t offset = 0; offset < tier.slotCount * sizeof(float); offset += m_pageSize)
+		{
+			if (!m_eeprom.write(tier.address + offset, blank, m_pageSize))
+				return false;
+			m_pageWrites++;
+		}
+	}
+
+	m_started = false;
+	return true;
+}
+
+
+/** Adds a sample to all tiers. Tiers whose interval has ended store the aggregate, intervals without samples are
+ *  stored as NaN. Samples older than the current interval are ignored.
+ *
+ * @param timestamp		Timestamp, in the units of the tier steps.
+ * @param value			Sample value.
+ * @return				False if writing a completed page failed.
+ */
+bool Eeprom24Rrd::update(uint32_t timestamp, float value)
+{
+	bool retval = true;
+
+	for (uint8_t i = 0; i < m_tierCount; i++)
+	{
+		Tier& tier = m_tiers[i];
+		uint32_t interval = timestamp / tier.step;
+
+		if (!m_started)
+		{
+			tier.interval = interval;
+			tier.pendingStart = interval;
+			tier.pendingCount = 0;
+			tier.samples = 0;
+		}
+
+		if (interval < tier.interval)
+			continue;
+
+		if (interval > tier.interval)
+		{
+			retval &= finishInterval(tier);
+
+			//a gap longer than the ring only needs one round of NaNs
+			if (interval - tier.interval > tier.slotCount)
+			{
+				retval &= writePending(tier);
+				tier.interval = interval - tier.slotCount;
+				tier.pendingStart = tier.interval;
+				tier.pendingCount = 0;
+			}
+
+			while (tier.interval < interval)
+				retval &= finishInterval(tier);
+		}
+
+		if (tier.samples == 0)
+			tier.accumulator = value;
+		else if (tier.function == AVERAGE)
+			tier.accumulator += value;
+		else if (tier.function == MINIMUM && value < tier.accumulator)
+			tier.accumulator = value;
+		else if (tier.function == MAXIMUM && value > tier.accumulator)
+			tier.accumulator = value;
+		else if (tier.function == LAST)
+			tier.accumulator = value;
+		tier.samples++;
+	}
+
+	m_started = true;
+	return retval;
+}
+
+
+/** Writes the partially filled pages of all tiers and the header with the progress of each tier. Aggregates still
+ *  being consolidated are not stored.
+ *
+ * @return				True if write operation was successful.
+ */
+bool Eeprom24Rrd::flush(void)
+{
+	bool retval = true;
+	for (uint8_t i = 0; i < m_tierCount; i++)
+		retval &= writePending(m_tiers[i]);
+
+	//before the first update there is no progress to record
+	return retval && (!m_started || writeHeader());
+}
+
+
+/** Reads finished intervals of a time range from the finest tier that still holds its beginning (or the coarsest
+ *  tier, if none does). Only the slots of that tier covering the range are read.
+ *
+ * @param from			Start of the range.
+ * @param to			End of the range, inclusive.
+ * @param values		Array receiving one value per interval, NaN for intervals without data.
+ * @param maxValues		Size of the array.
+ * @param start			Receives the start time of the first returned interval.
+ * @param step			Receives the step of the tier used.
+ * @return				Number of values returned.
+ */
+uint32_t Eeprom24Rrd::query(uint32_t from, uint32_t to, float* values, uint32_t maxValues, uint32_t* start, uint32_t* step)
+{
+	if (!m_started || m_tierCount == 0 || to < from)
+		return 0;
+
+	const Tier* tier = &m_tiers[m_tierCount - 1];
+	for (uint8_t i = 0; i < m_tierCount; i++)
+	{
+		const Tier& t = m_tiers[i];
+		uint32_t last = t.pendingStart + t.pendingCount;
+		uint32_t oldest = (last > t.slotCount) ? last - t.slotCount : 0;
+		if (from / t.step >= oldest)
+		{
+			tier = &t;
+			break;
+		}
+	}
+
+	uint32_t end = tier->pendingStart + tier->pendingCount;
+	uint32_t oldest = (end > tier->slotCount) ? end - tier->slotCount : 0;
+	uint32_t first = from / tier->step;
+	uint32_t last = to / tier->step + 1;
+	if (first < oldest)
+		first = oldest;
+	if (last > end)
+		last = end;
+	if (first >= last)
+		return 0;
+	if (last - first > maxValues)
+		last = first + maxValues;
+
+	*start = first * tier->step;
+	*step = tier->step;
+
+	//intervals already in the memory, in at most two runs because of the ring wrap
+	uint32_t stored = (last < tier->pendingStart) ? last : tier->pendingStart;
+	for (uint32_t k = first; k < stored; )
+	{
+		uint32_t slot = k % tier->slotCount;
+		uint32_t run = tier->slotCount - slot;
+		if (run > stored - k)
+			run = stored - k;
+
+		if (!m_eeprom.read(tier->address + slot * sizeof(float), reinterpret_cast<uint8_t*>(&values[k - first]), run * sizeof(float)))
+			return 0;
+		k += run;
+	}
+
+	for (uint32_t k = (first > tier->pendingStart) ? first : tier->pendingStart; k < last; k++)
+		values[k - first] = tier->pending[k - tier->pendingStart];
+
+	return last - first;
+}
+
+
+bool Eeprom24Rrd::writeHeader(void)
+{
+	uint32_t header[HEADER_WORDS + m_tierCount];
+	header[0] = MAGIC;
+	header[1] = getLayoutSignature();
+	for (uint8_t i = 0; i < m_tierCount; i++)
+		header[HEADER_WORDS + i] = m_tiers[i].pendingStart + m_tiers[i].pendingCount;
+
+	return m_eeprom.write(m_headerAddress, reinterpret_cast<const uint8_t*>(header), sizeof(header));
+}
+
+
+/** Identifies the tier layout: the tier count and a CRC of the address, size, step and function of every tier. */
+uint32_t Eeprom24Rrd::getLayoutSignature(void) const
+{
+	uint16_t crc = 0xFFFF;
+	for (uint8_t i = 0; i < m_tierCount; i++)
+	{
+		const Tier& tier = m_tiers[i];
+		uint32_t config[4] = {tier.address, tier.slotCount, tier.step, tier.function};
+		crc = eeprom24Crc16(reinterpret_cast<const uint8_t*>(config), sizeof(config), crc);
+	}
+	return ((uint32_t)m_tierCount << 16) | crc;
+}
+
+
+/** Stores the aggregate of the current interval (NaN if it had no samples) and moves on to the next one.
+ *
+ */
+bool Eeprom24Rrd::finishInterval(Tier& tier)
+{
+	float value = NAN;
+	if (tier.samples > 0)
+		value = (tier.function == AVERAGE) ? tier.accumulator / tier.samples : tier.accumulator;
+
+	tier.interval++;
+	tier.samples = 0;
+	return queueSlot(tier, value);
+}
+
+
+/** Adds a finished aggregate to the page buffer; the page is written once its last slot is filled.
+ *
+ */
+bool Eeprom24Rrd::queueSlot(Tier& tier, float value)
+{
+	tier.pending[tier.pendingCount++] = value;
+
+	uint32_t next = tier.pendingStart + tier.pendingCount;
+	if ((next % tier.slotCount) % getSlotsPerPage() != 0)
+		return true;
+
+	bool retval = writePending(tier);
+	tier.pendingStart = next;
+	tier.pendingCount = 0;
+	return retval;
+}
+
+
+/** Writes the queued aggregates of a tier; they always lie within one page.
+ *
+ */
+bool Eeprom24Rrd::writePending(Tier& tier)
+{
+	if (tier.pendingCount == 0)
+		return true;
+
+	uint32_t slot = tier.pendingStart % tier.slotCount;
+	if (!m_eeprom.write(tier.address + slot * sizeof(float), reinterpret_cast<const uint8_t*>(tier.pending), tier.pendingCount * sizeof(float)))
+		return false;
+
+	m_pageWrites++;
+	return true;
+}
@@ -0,0 +1,81 @@
+/* eeprom24_rrd.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_RRD_H_
+#define EEPROM24_RRD_H_
+
+#include "eeprom24.h"
+
+/** Round-robin database: several tiers of the same signal at decreasing resolution, e.g. 1 s, 1 min and 1 h. Each tier
+ *  is a ring of float slots indexed by time (slot = (t / step) % slotCount), so a time range maps directly to slot
+ *  addresses. Samples are consolidated in RAM; a finished aggregate is queued in the tier's page buffer and written
+ *  together with its neighbours once the page is complete. Missed intervals are stored as NaN.
+ *
+ *  Storage needed by a tier is 4 B per slot; a week at 1 s alone would need 2.4 MB, so size tiers to the memory.
+ *  Per-tier progress is persisted in a small header by flush(), call it periodically and before shutdown. The header
+ *  records the tier layout; mount() formats the store when the configured tiers don't match it.
+ */
+class Eeprom24Rrd
+{
+public:
+	enum Consolidation: uint8_t
+	{
+		AVERAGE,
+		MINIMUM,
+		MAXIMUM,
+		LAST,
+	};
+
+	struct Tier
+	{
+		uint32_t address;		///< page aligned
+		uint32_t slotCount;		///< a multiple of the slots per page
+		uint32_t step;			///< time per slot, in timestamp units
+		Consolidation function;
+
+		//runtime state
+		uint32_t interval;
+		float accumulator;
+		uint32_t samples;
+		uint32_t pendingStart;
+		uint16_t pendingCount;
+		float pending[EEPROM24_MAX_PAGE_SIZE / sizeof(float)];
+	};
+
+	Eeprom24Rrd(Eeprom24& eeprom, uint32_t headerAddress, Tier* tiers, uint8_t tierCount):
+		m_eeprom(eeprom), m_headerAddress(headerAddress), m_tiers(tiers), m_tierCount(tierCount),
+		m_pageSize((eeprom.getPageSizeInBytes() < EEPROM24_MAX_PAGE_SIZE) ? eeprom.getPageSizeInBytes() : EEPROM24_MAX_PAGE_SIZE) {};
+
+	bool mount(void);
+	bool format(void);
+	bool update(uint32_t timestamp, float value);
+	bool flush(void);
+
+	uint32_t query(uint32_t from, uint32_t to, float* values, uint32_t maxValues, uint32_t* start, uint32_t* step);
+
+	uint32_t getPageWrites(void) const {return m_pageWrites;};
+
+protected:
+	bool writeHeader(void);
+	uint32_t getLayoutSignature(void) const;
+	bool finishInterval(Tier& tier);
+	bool queueSlot(Tier& tier, float value);
+	bool writePending(Tier& tier);
+	uint16_t getSlotsPerPage(void) const {return m_pageSize / sizeof(float);};
+
+	Eeprom24& m_eeprom;
+	const uint32_t m_headerAddress;
+	Tier* const m_tiers;
+	const uint8_t m_tierCount;
+	const uint16_t m_pageSize;			///< clamped to EEPROM24_MAX_PAGE_SIZE, which sizes the tier page buffers
+
+	static constexpr uint32_t MAGIC = 0x52524431;
+	static constexpr uint8_t HEADER_WORDS = 2;		///< magic and layout signature, followed by the progress of each tier
+
+	bool m_started = false;
+	uint32_t m_pageWrites = 0;
+};
+
+#endif /* EEPROM24_RRD_H_ */
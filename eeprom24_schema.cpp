@@ -0,0 +1,286 @@
+/* eeprom24_schema.cpp
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#include <string.h>
+#include "eeprom24_schema.h"
+#include "custom_assert.h"
+
+
+Eeprom24Schema::Eeprom24Schema(Eeprom24& eeprom, uint32_t address, const Eeprom24SchemaVersion* versions, uint8_t versionCount):
+	m_eeprom(eeprom), m_address(address), m_versions(versions), m_versionCount(versionCount)
+{
+	assert(Eeprom24SchemaVersion::isOrdered(versions, versionCount));
+
+	for (uint8_t i = 0; i < versionCount; i++)
+	{
+		if (versions[i].size > m_maxSize)
+			m_maxSize = versions[i].size;
+	}
+}
+
+
+/** Checks the stored version and brings the record up to the newest one, finishing an interrupted migration step
+ *  first. Blank memory is formatted with default values; an unknown version or a corrupt header is reported and left
+ *  alone, so that data of newer firmware isn't lost by a downgrade.
+ *
+ * @return				What had to be done, or SCHEMA_ERROR if the memory couldn't be accessed.
+ */
+Eeprom24Schema::Result Eeprom24Schema::mount(void)
+{
+	m_fieldsWritten = 0;
+
+	//a committed step is finished before the header is looked at, as it may have been torn by the power loss
+	bool recovered = false;
+	if (!recover(recovered))
+		return SCHEMA_ERROR;
+
+	uint8_t header[HEADER_SIZE];
+	if (!m_eeprom.read(m_address, header, sizeof(header)))
+		return SCHEMA_ERROR;
+
+	uint16_t magic = header[0] | (header[1] << 8);
+	m_storedVersion = header[2] | (header[3] << 8);
+
+	if (magic != MAGIC)
+	{
+		bool blank = (header[0] & header[1] & header[2] & header[3]) == 0xFF;
+		if (!blank)
+			return SCHEMA_CORRUPT;
+		return format() ? SCHEMA_FORMATTED : SCHEMA_ERROR;
+	}
+
+	uint16_t mountedVersion = m_storedVersion;
+	const Eeprom24SchemaVersion* current = findVersion(m_storedVersion);
+	if (current == nullptr)
+		return SCHEMA_UNKNOWN;
+
+	//one journaled step at a time; the versions are in ascending order, so the next entry is the next version
+	const Eeprom24SchemaVersion* latest = &m_versions[m_versionCount - 1];
+	for (; current != latest; current++)
+	{
+		if (!migrate(current[0], current[1]))
+			return SCHEMA_ERROR;
+	}
+
+	return (m_storedVersion == mountedVersion && !recovered) ? SCHEMA_CURRENT : SCHEMA_MIGRATED;
+}
+
+
+/** Writes the newest version with default values.
+ *
+ * @return				True if write operation was successful.
+ */
+bool Eeprom24Schema::format(void)
+{
+	const Eeprom24SchemaVersion& latest = m_versions[m_versionCount - 1];
+	uint8_t image[latest.size];
+	memset(image, 0, sizeof(image));
+
+	for (uint8_t i = 0; i < latest.fieldCount; i++)
+	{
+		const Eeprom24Field& field = latest.fields[i];
+		if (field.defaultValue)
+			memcpy(&image[field.offset], field.defaultValue, field.size);
+	}
+
+	if (!m_eeprom.write(getDataAddress(), image, sizeof(image)) || !writeHeader(latest.version))
+		return false;
+
+	m_storedVersion = latest.version;
+	m_fieldsWritten += latest.fieldCount;
+	return true;
+}
+
+
+const Eeprom24SchemaVersion* Eeprom24Schema::findVersion(uint16_t version) const
+{
+	for (uint8_t i = 0; i < m_versionCount; i++)
+	{
+		if (m_versions[i].version == version)
+			return &m_versions[i];
+	}
+	return nullptr;
+}
+
+
+/** A field has to be written by a migration if it is new, moved, resized or transformed. */
+bool Eeprom24Schema::isChanged(const Eeprom24SchemaVersion& from, const Eeprom24Field& field)
+{
+	const Eeprom24Field* old = from.find(field.id);
+	return !(old && old->offset == field.offset && old->size == field.size && field.transform == nullptr);
+}
+
+
+/** Number of bytes a migration step stages: the new values of all changed fields, in field table order.
+ *
+ */
+uint16_t Eeprom24Schema::getStagedSize(const Eeprom24SchemaVersion& from, const Eeprom24SchemaVersion& to) const
+{
+	uint16_t size = 0;
+	for (uint8_t i = 0; i < to.fieldCount; i++)
+	{
+		if (isChanged(from, to.fields[i]))
+			size += to.fields[i].size;
+	}
+	return size;
+}
+
+
+/** Migrates from one version to the next. The new values of the changed fields are computed from the old ones and
+ *  staged first; once the journal header commits them, they are applied and the version header is updated. Fields
+ *  that stay in place are not touched at all.
+ *
+ * @param from			Stored version.
+ * @param to			Version to migrate to.
+ * @return				True if the step was completed.
+ */
+bool Eeprom24Schema::migrate(const Eeprom24SchemaVersion& from, const Eeprom24SchemaVersion& to)
+{
+	uint16_t length = getStagedSize(from, to);
+	uint8_t staged[length + 1];
+	uint16_t position = 0;
+
+	for (uint8_t i = 0; i < to.fieldCount; i++)
+	{
+		const Eeprom24Field& field = to.fields[i];
+		if (!isChanged(from, field))
+			continue;
+
+		const Eeprom24Field* old = from.find(field.id);
+		uint8_t* value = &staged[position];
+		position += field.size;
+
+		if (old == nullptr)
+		{
+			if (field.defaultValue)
+				memcpy(value, field.defaultValue, field.size);
+			else
+				memset(value, 0, field.size);
+			continue;
+		}
+
+		uint8_t oldValue[old->size];
+		if (!m_eeprom.read(getDataAddress() + old->offset, oldValue, old->size))
+			return false;
+
+		if (field.transform)
+			field.transform(oldValue, old->size, value, field.size);
+		else
+		{
+			memset(value, 0, field.size);
+			memcpy(value, oldValue, (old->size < field.size) ? old->size : field.size);
+		}
+	}
+
+	//the journal header goes last and commits the step; until then, nothing of the stored version has changed
+	if (length > 0)
+	{
+		uint8_t journal[JOURNAL_HEADER_SIZE] = {(uint8_t)(JOURNAL_MAGIC & 0xFF), (uint8_t)(JOURNAL_MAGIC >> 8),
+			(uint8_t)(from.version & 0xFF), (uint8_t)(from.version >> 8), (uint8_t)(to.version & 0xFF),
+			(uint8_t)(to.version >> 8), (uint8_t)(length & 0xFF), (uint8_t)(length >> 8), 0, 0};
+		uint16_t crc = eeprom24Crc16(staged, length, eeprom24Crc16(journal, JOURNAL_HEADER_SIZE - 2));
+		journal[8] = crc & 0xFF;
+		journal[9] = crc >> 8;
+
+		if (!m_eeprom.write(getStagingAddress(), staged, length) || !m_eeprom.write(getJournalAddress(), journal, sizeof(journal)))
+			return false;
+	}
+
+	if (!apply(from, to, staged) || !writeHeader(to.version))
+		return false;
+
+	m_storedVersion = to.version;
+	return (length == 0) || clearJournal();
+}
+
+
+/** Finishes a migration step that was committed but not completed before a power loss. The journal is only valid
+ *  between its commit and the clear that follows the header update, so it is applied whatever the header holds; the
+ *  header may be the old version, the new one, or torn. A journal that fails its CRC because it was never fully
+ *  written, or doesn't match the version table, is discarded.
+ *
+ * @param recovered		Set if a step was finished.
+ * @return				True unless the memory couldn't be accessed.
+ */
+bool Eeprom24Schema::recover(bool& recovered)
+{
+	uint8_t journal[JOURNAL_HEADER_SIZE];
+	if (!m_eeprom.read(getJournalAddress(), journal, sizeof(journal)))
+		return false;
+
+	if ((journal[0] | (journal[1] << 8)) != JOURNAL_MAGIC)
+		return true;
+
+	uint16_t from = journal[2] | (journal[3] << 8);
+	uint16_t to = journal[4] | (journal[5] << 8);
+	uint16_t length = journal[6] | (journal[7] << 8);
+	const Eeprom24SchemaVersion* source = findVersion(from);
+
+	if (source == nullptr || source == &m_versions[m_versionCount - 1] ||
+		source[1].version != to || length != getStagedSize(source[0], source[1]))
+		return clearJournal();
+
+	uint8_t staged[length + 1];
+	if (!m_eeprom.read(getStagingAddress(), staged, length))
+		return false;
+
+	uint16_t crc = eeprom24Crc16(staged, length, eeprom24Crc16(journal, JOURNAL_HEADER_SIZE - 2));
+	if ((journal[8] | (journal[9] << 8)) != crc)
+		return clearJournal();
+
+	if (!apply(source[0], source[1], staged) || !writeHeader(to))
+		return false;
+
+	recovered = true;
+	return clearJournal();
+}
+
+
+/** Writes the staged values of the changed fields; repeating it after an interruption gives the same result.
+ *
+ * @param from			Stored version.
+ * @param to			Version to migrate to.
+ * @param staged		New values of the changed fields, in field table order.
+ * @return				True if all changed fields were written.
+ */
+bool Eeprom24Schema::apply(const Eeprom24SchemaVersion& from, const Eeprom24SchemaVersion& to, const uint8_t* staged)
+{
+	for (uint8_t i = 0; i < to.fieldCount; i++)
+	{
+		const Eeprom24Field& field = to.fields[i];
+		if (!isChanged(from, field))
+			continue;
+
+		if (!writeField(field, staged))
+			return false;
+		staged += field.size;
+	}
+
+	return true;
+}
+
+
+bool Eeprom24Schema::writeField(const Eeprom24Field& field, const uint8_t* value)
+{
+	if (!m_eeprom.write(getDataAddress() + field.offset, value, field.size))
+		return false;
+
+	m_fieldsWritten++;
+	return true;
+}
+
+
+bool Eeprom24Schema::writeHeader(uint16_t version)
+{
+	uint8_t header[HEADER_SIZE] = {(uint8_t)(MAGIC & 0xFF), (uint8_t)(MAGIC >> 8), (uint8_t)(version & 0xFF), (uint8_t)(version >> 8)};
+	return m_eeprom.write(m_address, header, sizeof(header)) && m_eeprom.waitForReady();
+}
+
+
+bool Eeprom24Schema::clearJournal(void)
+{
+	uint8_t cleared[2] = {0, 0};
+	return m_eeprom.write(getJournalAddress(), cleared, sizeof(cleared));
+}
@@ -0,0 +1,148 @@
+/* eeprom24_schema.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_SCHEMA_H_
+#define EEPROM24_SCHEMA_H_
+
+#include <stddef.h>
+#include "eeprom24.h"
+#include "eeprom24_crc.h"
+
+/** Describes one field of a stored struct. Fields keep their id across versions; a field with the same id, offset
+ *  and size is left in place by a migration. */
+struct Eeprom24Field
+{
+	uint16_t id;
+	uint16_t offset;
+	uint16_t size;
+	const void* defaultValue;		///< value for fields new in this version, null for zeros
+	void (*transform)(const uint8_t* old, uint16_t oldSize, uint8_t* value, uint16_t size);	///< optional conversion from the previous version
+};
+
+/** Field table of one version of a stored struct. */
+struct Eeprom24SchemaVersion
+{
+	uint16_t version;
+	uint16_t size;
+	const Eeprom24Field* fields;
+	uint8_t fieldCount;
+
+	/** Checks that all fields lie within the struct and don't overlap; meant for static_assert. */
+	constexpr bool isValid(void) const
+	{
+		for (uint8_t i = 0; i < fieldCount; i++)
+		{
+			if (fields[i].size == 0 || fields[i].offset + fields[i].size > size)
+				return false;
+
+			for (uint8_t j = i + 1; j < fieldCount; j++)
+			{
+				if (fields[i].id == fields[j].id)
+					return false;
+				if (fields[i].offset < fields[j].offset + fields[j].size && fields[j].offset < fields[i].offset + fields[i].size)
+					return false;
+			}
+		}
+		return true;
+	};
+
+	constexpr const Eeprom24Field* find(uint16_t id) const
+	{
+		for (uint8_t i = 0; i < fieldCount; i++)
+		{
+			if (fields[i].id == id)
+				return &fields[i];
+		}
+		return nullptr;
+	};
+
+	/** Checks that a version table is in strictly ascending order; meant for static_assert. */
+	static constexpr bool isOrdered(const Eeprom24SchemaVersion* versions, uint8_t count)
+	{
+		for (uint8_t i = 1; i < count; i++)
+		{
+			if (versions[i].version <= versions[i - 1].version)
+				return false;
+		}
+		return count > 0;
+	};
+};
+
+/** Field descriptor from a struct member. */
+#define EEPROM24_FIELD(type, member, id)					{(id), offsetof(type, member), sizeof(type::member), nullptr, nullptr}
+#define EEPROM24_FIELD_DEFAULT(type, member, id, value)		{(id), offsetof(type, member), sizeof(type::member), (value), nullptr}
+#define EEPROM24_FIELD_TRANSFORM(type, member, id, fn)		{(id), offsetof(type, member), sizeof(type::member), nullptr, (fn)}
+
+/** Version table entry from a struct and its field array. */
+#define EEPROM24_SCHEMA_VERSION(number, type, fields)		{(number), sizeof(type), (fields), sizeof(fields) / sizeof(Eeprom24Field)}
+
+
+/** Versioned record: a small header with the schema version followed by the struct. When the stored version is older
+ *  than the newest one, mount() migrates it step by step, touching only fields that are new, moved, resized or
+ *  transformed, so the time taken scales with the number of changed fields rather than the struct size.
+ *
+ *  Each step is journaled: the new values of the changed fields are staged behind the struct and committed with a
+ *  CRC'd journal header before any field is overwritten. A step interrupted by power loss is finished on the next
+ *  mount by applying the staged values again, so transforms in place, fields moving over each other and a torn
+ *  version header are safe.
+ *  The record takes getFootprint() bytes: header, the largest version, journal header and staging area.
+ *
+ *  The version table must be in ascending order (see Eeprom24SchemaVersion::isOrdered()) and every version that may
+ *  be stored has to be present, as a step migrates to the next entry of the table.
+ */
+class Eeprom24Schema
+{
+public:
+	enum Result
+	{
+		SCHEMA_CURRENT,
+		SCHEMA_MIGRATED,
+		SCHEMA_FORMATTED,		///< the memory was blank
+		SCHEMA_UNKNOWN,			///< stored version is not in the table, e.g. written by newer firmware; left untouched
+		SCHEMA_CORRUPT,			///< header is neither valid nor blank; left untouched, format() to start over
+		SCHEMA_ERROR,
+	};
+
+	Eeprom24Schema(Eeprom24& eeprom, uint32_t address, const Eeprom24SchemaVersion* versions, uint8_t versionCount);
+
+	Result mount(void);
+	bool format(void);
+
+	uint32_t getDataAddress(void) const {return m_address + HEADER_SIZE;};
+	uint32_t getFootprint(void) const {return HEADER_SIZE + JOURNAL_HEADER_SIZE + 2 * m_maxSize;};
+	uint16_t getStoredVersion(void) const {return m_storedVersion;};
+	uint16_t getFieldsWritten(void) const {return m_fieldsWritten;};
+
+	static constexpr uint16_t MAGIC = 0x5E24;
+	static constexpr uint16_t JOURNAL_MAGIC = 0x5E4A;
+	static constexpr uint8_t HEADER_SIZE = 4;
+	static constexpr uint8_t JOURNAL_HEADER_SIZE = 10;
+
+protected:
+	const Eeprom24SchemaVersion* findVersion(uint16_t version) const;
+	static bool isChanged(const Eeprom24SchemaVersion& from, const Eeprom24Field& field);
+	uint16_t getStagedSize(const Eeprom24SchemaVersion& from, const Eeprom24SchemaVersion& to) const;
+	bool migrate(const Eeprom24SchemaVersion& from, const Eeprom24SchemaVersion& to);
+	bool stage(const Eeprom24SchemaVersion& from, const Eeprom24SchemaVersion& to);
+	bool recover(bool& recovered);
+	bool apply(const Eeprom24SchemaVersion& from, const Eeprom24SchemaVersion& to, const uint8_t* staged);
+	bool writeField(const Eeprom24Field& field, const uint8_t* value);
+	bool writeHeader(uint16_t version);
+	bool clearJournal(void);
+
+	uint32_t getJournalAddress(void) const {return getDataAddress() + m_maxSize;};
+	uint32_t getStagingAddress(void) const {return getJournalAddress() + JOURNAL_HEADER_SIZE;};
+
+	Eeprom24& m_eeprom;
+	const uint32_t m_address;
+	const Eeprom24SchemaVersion* const m_versions;
+	const uint8_t m_versionCount;
+	uint16_t m_maxSize = 0;
+
+	uint16_t m_storedVersion = 0;
+	uint16_t m_fieldsWritten = 0;
+};
+
+#endif /* EEPROM24_SCHEMA_H_ */
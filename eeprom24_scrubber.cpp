@@ -0,0 +1,285 @@
+/* eeprom24_scrubber.cpp
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#include <string.h>
+#include "eeprom24_crc.h"
+#include "eeprom24_scrubber.h"
+
+
+/** Sets up scrubbing of a region; the default period is a day, CRCs of written pages are updated after a second.
+ *
+ * @param eeprom		Memory to check.
+ * @param address		Start of the region, page aligned.
+ * @param pageCount		Number of pages of the region.
+ * @param crcAddress	Start of the CRC table, 2 bytes per page and 4 for the saved cursor, outside of the region.
+ */
+Eeprom24Scrubber::Eeprom24Scrubber(Eeprom24& eeprom, uint32_t address, uint16_t pageCount, uint32_t crcAddress):
+	m_eeprom(eeprom), m_address(address), m_pageCount(pageCount), m_crcAddress(crcAddress),
+	m_pageSize((eeprom.getPageSizeInBytes() < EEPROM24_MAX_PAGE_SIZE) ? eeprom.getPageSizeInBytes() : EEPROM24_MAX_PAGE_SIZE)
+{
+	m_lastCheck = HAL_GetTick();
+	m_passStart = m_lastCheck;
+}
+
+
+/** Restores the cursor saved by a previous run; a blank or torn one starts a new pass.
+ *
+ * @return				True if the saved cursor could be read.
+ */
+bool Eeprom24Scrubber::mount(void)
+{
+	uint16_t saved[2];
+	if (!m_eeprom.read(getCursorAddress(), reinterpret_cast<uint8_t*>(saved), sizeof(saved)))
+		return false;
+
+	//stored with its complement, which a blank or half-written entry doesn't match
+	m_cursor = (saved[1] == (uint16_t)~saved[0] && saved[0] < m_pageCount) ? saved[0] : 0;
+	m_cursorDirty = false;
+	m_lastCheck = HAL_GetTick();
+	m_passStart = m_lastCheck;
+	return true;
+}
+
+
+/** Writes to the region and marks the CRCs of the touched pages for update.
+ *
+ * @param address		Address to start writing at, within the region.
+ * @param data			Pointer to an array with data to be written.
+ * @param length		How many bytes to write.
+ * @return				True if the data was written, and the pending CRCs if the set had to be flushed.
+ */
+bool Eeprom24Scrubber::write(uint32_t address, const uint8_t* data, uint32_t length)
+{
+	if (address < m_address || address + length > getPageAddress(m_pageCount))
+		return false;
+	if (length == 0)
+		return true;
+	if (!m_eeprom.write(address, data, length))
+		return false;
+
+	uint16_t last = (address + length - 1 - m_address) / m_pageSize;
+	for (uint16_t page = (address - m_address) / m_pageSize; page <= last; page++)
+	{
+		if (!addPending(page))
+			return false;
+	}
+	return true;
+}
+
+
+/** Writes all pending CRCs, a run of neighbouring table entries at a time; e.g. before a planned shutdown.
+ *
+ * @return				True if no CRC is pending any more.
+ */
+bool Eeprom24Scrubber::flush(void)
+{
+	while (m_pendingCount > 0)
+	{
+		if (!flushRun())
+			return false;
+	}
+	return true;
+}
+
+
+/** Writes the CRCs of the first run of consecutive pending pages in a single write and removes them from the set.
+ *
+ * @return				True if the run was written.
+ */
+bool Eeprom24Scrubber::flushRun(void)
+{
+	uint16_t crcs[PENDING_PAGES];
+	uint8_t image[EEPROM24_MAX_PAGE_SIZE];
+
+	//the set is sorted, so a run of consecutive pages is a run of consecutive entries
+	uint8_t run = 1;
+	while (run < m_pendingCount && m_pending[run] == m_pending[0] + run)
+		run++;
+
+	for (uint8_t i = 0; i < run; i++)
+	{
+		if (!m_eeprom.read(getPageAddress(m_pending[i]), image, m_pageSize))
+			return false;
+		crcs[i] = getCrc(image);
+	}
+
+	if (!m_eeprom.write(getCrcAddress(m_pending[0]), reinterpret_cast<const uint8_t*>(crcs), run * sizeof(uint16_t)))
+		return false;
+
+	m_stats.crcWrites++;
+	m_pendingCount -= run;
+	memmove(m_pending, m_pending + run, m_pendingCount * sizeof(uint16_t));
+	return true;
+}
+
+
+/** Checks the page under the cursor if it is due, or writes the pending CRCs; to be called from the idle loop.
+ *
+ * @return				True if a page was checked.
+ */
+bool Eeprom24Scrubber::tick(void)
+{
+	if (m_pageCount == 0)
+		return false;
+
+	//a probe that is not due yet costs no bus traffic
+	if (m_eeprom.isWritePending() && !m_eeprom.isReady())
+		return false;
+
+	//one write per tick: the remaining runs keep their age and go out on the next ticks
+	uint32_t now = HAL_GetTick();
+	if (m_pendingCount > 0 && now - m_pendingSince >= m_crcDelay)
+	{
+		flushRun();
+		return false;
+	}
+
+	if (m_cursorDirty)
+	{
+		saveCursor();
+		return false;
+	}
+
+	uint32_t interval = m_period / m_pageCount;
+	if (now - m_lastCheck < interval)
+		return false;
+
+	m_lastCheck = now;
+	if (!checkPage(m_cursor))
+		return false;
+
+	m_stats.pagesChecked++;
+	if (++m_cursor == m_pageCount)
+	{
+		m_cursor = 0;
+		m_stats.passes++;
+		m_stats.lastPassDuration = now - m_passStart;
+		m_passStart = now;
+	}
+	if (m_cursor % CURSOR_SAVE_PAGES == 0)
+		m_cursorDirty = true;
+	return true;
+}
+
+
+/** Saves the cursor behind the CRC table, for mount() after a reset.
+ *
+ * @return				True if it was written.
+ */
+bool Eeprom24Scrubber::saveCursor(void)
+{
+	uint16_t saved[2] = {m_cursor, (uint16_t)~m_cursor};
+	if (!m_eeprom.write(getCursorAddress(), reinterpret_cast<const uint8_t*>(saved), sizeof(saved)))
+		return false;
+
+	m_cursorDirty = false;
+	return true;
+}
+
+
+/** Verifies a page against its CRC, refreshing it if a retry reads it correctly.
+ *
+ * @return				False if the memory couldn't be accessed; the page is checked again next time.
+ */
+bool Eeprom24Scrubber::checkPage(uint16_t page)
+{
+	uint16_t stored;
+	uint8_t image[EEPROM24_MAX_PAGE_SIZE];
+
+	//its CRC is about to be rewritten from the current content
+	if (isPending(page))
+		return true;
+
+	if (!m_eeprom.read(getCrcAddress(page), reinterpret_cast<uint8_t*>(&stored), sizeof(stored)))
+		return false;
+
+	if (stored == NO_CRC)
+	{
+		if (!updateCrc(page))
+			return false;
+		m_stats.pagesSealed++;
+		return true;
+	}
+
+	for (uint8_t attempt = 0; attempt <= READ_RETRIES; attempt++)
+	{
+		if (!m_eeprom.read(getPageAddress(page), image, m_pageSize))
+			return false;
+		if (getCrc(image) != stored)
+			continue;
+
+		if (attempt == 0)
+			return true;
+
+		//a marginal page read correctly; rewriting it restores the cells
+		if (!m_eeprom.write(getPageAddress(page), image, m_pageSize))
+			return false;
+		m_stats.pagesRefreshed++;
+		return true;
+	}
+
+	m_stats.pagesFailed++;
+	if (m_onError)
+		m_onError(getPageAddress(page), m_context);
+	return true;
+}
+
+
+bool Eeprom24Scrubber::updateCrc(uint16_t page)
+{
+	uint8_t image[EEPROM24_MAX_PAGE_SIZE];
+	if (!m_eeprom.read(getPageAddress(page), image, m_pageSize))
+		return false;
+
+	uint16_t crc = getCrc(image);
+	m_stats.crcWrites++;
+	return m_eeprom.write(getCrcAddress(page), reinterpret_cast<const uint8_t*>(&crc), sizeof(crc));
+}
+
+
+/** Adds a page to the sorted pending set; if the set is full, the CRCs of its first run are written to make room.
+ *
+ */
+bool Eeprom24Scrubber::addPending(uint16_t page)
+{
+	if (isPending(page))
+		return true;
+	if (m_pendingCount == PENDING_PAGES && !flushRun())
+		return false;
+
+	if (m_pendingCount == 0)
+		m_pendingSince = HAL_GetTick();
+
+	uint8_t i = m_pendingCount;
+	while (i > 0 && m_pending[i - 1] > page)
+	{
+		m_pending[i] = m_pending[i - 1];
+		i--;
+	}
+	m_pending[i] = page;
+	m_pendingCount++;
+	return true;
+}
+
+
+bool Eeprom24Scrubber::isPending(uint16_t page) const
+{
+	for (uint8_t i = 0; i < m_pendingCount; i++)
+	{
+		if (m_pending[i] == page)
+			return true;
+	}
+	return false;
+}
+
+
+/** CRC of a page image; NO_CRC is reserved for the blank table, a page hashing to it stores 0.
+ *
+ */
+uint16_t Eeprom24Scrubber::getCrc(const uint8_t* image) const
+{
+	uint16_t crc = eeprom24Crc16(image, m_pageSize);
+	return (crc == NO_CRC) ? 0 : crc;
+}
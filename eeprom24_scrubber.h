@@ -0,0 +1,99 @@
+/* eeprom24_scrubber.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_SCRUBBER_H_
+#define EEPROM24_SCRUBBER_H_
+
+#include "eeprom24.h"
+
+/** Background integrity check of a region, run from idle time. Every page has a CRC-16 in a separate table; each tick()
+ *  verifies at most one page and moves a cursor on, paced so that the whole region is covered once per period. The
+ *  cursor is saved behind the table every CURSOR_SAVE_PAGES pages and restored by mount(), so a device that is reset
+ *  more often than the period still gets the whole region checked; at most the pages since the last save are rechecked.
+ *
+ *  A page that fails its CRC is read again; if a retry matches, the page is weak and is refreshed by rewriting it with
+ *  the good data. A page that never matches is reported as an uncorrectable error. Pages without a CRC yet (blank table)
+ *  get one the first time they are checked. Writes to the region must go through write(), which keeps the CRCs current.
+ *
+ *  The CRCs of written pages are not updated with every write, which would double the write cycles and wear the table
+ *  page fastest of all: write() notes the page in a RAM set of PENDING_PAGES entries, and the CRCs are written in
+ *  batches - runs of neighbouring entries in one write - one run per tick() once the oldest is crcDelay old, or by
+ *  write() when the set is full. Repeated writes to a page cost one CRC update. Pending pages are not checked. A reset
+ *  loses the pending set, and the pages in it are reported by their next check; call flush() before a planned shutdown.
+ *
+ *  A tick costs at most READ_RETRIES + 1 page reads, a 2 byte read and a page write; or the page reads and the write of
+ *  one run of CRCs; or saving the cursor. It never waits for a write cycle: while one is running, the tick is skipped.
+ */
+class Eeprom24Scrubber
+{
+public:
+	struct Stats
+	{
+		uint32_t passes;			///< complete passes over the region
+		uint32_t pagesChecked;
+		uint32_t pagesRefreshed;	///< weak pages rewritten
+		uint32_t pagesFailed;		///< uncorrectable errors
+		uint32_t pagesSealed;		///< pages that got their first CRC
+		uint32_t crcWrites;			///< writes to the CRC table
+		uint32_t lastPassDuration;	///< in ms
+	};
+
+	Eeprom24Scrubber(Eeprom24& eeprom, uint32_t address, uint16_t pageCount, uint32_t crcAddress);
+
+	void setPeriod(uint32_t period) {m_period = period;};
+	void setCrcDelay(uint32_t delay) {m_crcDelay = delay;};
+	void setErrorHandler(void (*handler)(uint32_t address, void* context), void* context) {m_onError = handler; m_context = context;};
+
+	bool mount(void);
+	bool write(uint32_t address, const uint8_t* data, uint32_t length);
+	bool flush(void);
+	bool tick(void);
+
+	uint16_t getCursor(void) const {return m_cursor;};
+	uint8_t getCoverage(void) const {return m_pageCount ? (uint32_t)m_cursor * 100 / m_pageCount : 100;};
+	uint8_t getPendingPages(void) const {return m_pendingCount;};
+	const Stats& getStats(void) const {return m_stats;};
+	void resetStats(void) {m_stats = {};};
+
+	static constexpr uint8_t READ_RETRIES = 3;
+	static constexpr uint8_t PENDING_PAGES = 8;
+	static constexpr uint16_t NO_CRC = 0xFFFF;
+	static constexpr uint16_t CURSOR_SAVE_PAGES = 16;
+
+protected:
+	bool checkPage(uint16_t page);
+	bool updateCrc(uint16_t page);
+	bool flushRun(void);
+	bool saveCursor(void);
+	bool addPending(uint16_t page);
+	bool isPending(uint16_t page) const;
+	uint16_t getCrc(const uint8_t* image) const;
+	uint32_t getPageAddress(uint16_t page) const {return m_address + (uint32_t)page * m_pageSize;};
+	uint32_t getCrcAddress(uint16_t page) const {return m_crcAddress + (uint32_t)page * sizeof(uint16_t);};
+	uint32_t getCursorAddress(void) const {return getCrcAddress(m_pageCount);};
+
+	Eeprom24& m_eeprom;
+	const uint32_t m_address;
+	const uint16_t m_pageCount;
+	const uint32_t m_crcAddress;
+	const uint16_t m_pageSize;
+
+	uint32_t m_period = 24UL * 3600 * 1000;
+	uint32_t m_crcDelay = 1000;
+	void (*m_onError)(uint32_t address, void* context) = nullptr;
+	void* m_context = nullptr;
+
+	uint16_t m_cursor = 0;
+	bool m_cursorDirty = false;
+	uint32_t m_lastCheck = 0;
+	uint32_t m_passStart = 0;
+	Stats m_stats = {};
+
+	uint16_t m_pending[PENDING_PAGES];		///< pages with a stale CRC, in ascending order
+	uint8_t m_pendingCount = 0;
+	uint32_t m_pendingSince = 0;
+};
+
+#endif /* EEPROM24_SCRUBBER_H_ */
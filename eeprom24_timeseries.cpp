@@ -0,0 +1,672 @@
+/* eeprom24_timeseries.cpp
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "eeprom24_timeseries.h"
+#include "custom_assert.h"
+
+
+Eeprom24TimeSeries::Eeprom24TimeSeries(Eeprom24& eeprom, uint32_t address, uint16_t blockCount):
+	m_eeprom(eeprom), m_address(address), m_blockCount(blockCount),
+	m_pageSize((eeprom.getPageSizeInBytes() < EEPROM24_MAX_PAGE_SIZE) ? eeprom.getPageSizeInBytes() : EEPROM24_MAX_PAGE_SIZE)
+{
+	assert(m_pageSize > HEADER_SIZE);
+}
+
+
+/** Finds the newest block and continues after it; an unsealed newest block is reopened and appended to. A newest
+ *  block whose payload fails its CRC was torn by its first write and is dropped. The RAM index, if set, is filled
+ *  from the same scan.
+ *
+ * @return				True if the region could be scanned.
+ */
+bool Eeprom24TimeSeries::mount(void)
+{
+	BlockHeader header;
+	uint16_t newest = 0;
+	bool found = false;
+	uint32_t newestSequence = 0;
+	uint8_t slot = 0;
+
+	m_open = false;
+	for (uint16_t i = 0; i < m_blockCount; i++)
+	{
+		if (!readHeader(i, &header, nullptr))
+			return false;
+
+		if (m_index)
+			m_index[i] = (header.sequence != 0xFFFFFFFF) ? header.timestamp : NO_TIMESTAMP;
+
+		if (header.sequence != 0xFFFFFFFF && (!found || (int32_t)(header.sequence - newestSequence) > 0))
+		{
+			newest = i;
+			newestSequence = header.sequence;
+			found = true;
+		}
+	}
+
+	while (found)
+	{
+		if (!loadBlock(newest, m_block, &header, &slot))
+			return false;
+		if (header.sequence == newestSequence)
+			break;
+
+		//torn by its first write; the block before it is the newest, if there is one
+		uint16_t previous = (newest + m_blockCount - 1) % m_blockCount;
+		if (!readHeader(previous, &header, nullptr))
+			return false;
+		found = (header.sequence != 0xFFFFFFFF && header.sequence == newestSequence - 1);
+		newest = previous;
+		newestSequence--;
+	}
+
+	m_head = 0;
+	m_sequence = 0;
+	m_wrapped = false;
+
+	if (!found)
+		return true;
+
+	m_head = newest;
+	m_sequence = newestSequence;
+
+	//a block that doesn't decode as far as its commit claims isn't appended to
+	bool sealed = (header.bits & BLOCK_SEALED) != 0;
+	if (!sealed && decodeBlock(header, m_block + HEADER_SIZE, nullptr, 0, &m_codec) != header.count)
+		sealed = true;
+
+	if (sealed)
+	{
+		m_head = (newest + 1) % m_blockCount;
+		m_sequence++;
+	}
+	else
+	{
+		m_header = header;
+		m_codec.end = getCapacity();
+		m_slot = slot;
+		m_written = true;
+		m_flushedBits = header.bits;
+		m_flushedCount = header.count;
+		m_open = true;
+	}
+
+	if (!readHeader((m_head + 1) % m_blockCount, &header, nullptr))
+		return false;
+	m_wrapped = (header.sequence != 0xFFFFFFFF);
+	return true;
+}
+
+
+/** Appends a sample to the open block; a full block is written to the memory and the next one is started.
+ *
+ * @param timestamp		Timestamp in any unit, should be non-decreasing.
+ * @param value			Sample value.
+ * @return				False if writing a full block failed.
+ */
+bool Eeprom24TimeSeries::append(uint32_t timestamp, float value)
+{
+	m_samplesAppended++;
+
+	if (!m_open)
+	{
+		startBlock(timestamp, value);
+		return true;
+	}
+
+	//timestamp: delta-of-delta with prefix codes
+	int32_t delta = (int32_t)(timestamp - m_codec.timestamp);
+	int32_t dod = (int32_t)((uint32_t)delta - (uint32_t)m_codec.delta);
+	uint32_t timeCode, timePayload;
+	uint8_t timeCodeBits, timePayloadBits;
+
+	if (dod == 0)
+	{
+		timeCode = 0b0;	timeCodeBits = 1;
+		timePayload = 0; timePayloadBits = 0;
+	}
+	else if (dod >= -63 && dod <= 64)
+	{
+		timeCode = 0b10; timeCodeBits = 2;
+		timePayload = dod + 63; timePayloadBits = 7;
+	}
+	else if (dod >= -255 && dod <= 256)
+	{
+		timeCode = 0b110; timeCodeBits = 3;
+		timePayload = dod + 255; timePayloadBits = 9;
+	}
+	else if (dod >= -2047 && dod <= 2048)
+	{
+		timeCode = 0b1110; timeCodeBits = 4;
+		timePayload = dod + 2047; timePayloadBits = 12;
+	}
+	else
+	{
+		timeCode = 0b1111; timeCodeBits = 4;
+		timePayload = dod; timePayloadBits = 32;
+	}
+
+	//value: XOR with the previous one, reusing the previous window of meaningful bits when the new one fits in it
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	uint32_t x = bits ^ m_codec.value;
+	uint8_t leading = m_codec.leading, trailing = m_codec.trailing;
+	uint8_t valueBits;
+	bool newWindow = false;
+
+	if (x == 0)
+		valueBits = 1;
+	else
+	{
+		uint8_t lz = __builtin_clz(x), tz = __builtin_ctz(x);
+
+		if (m_codec.leading <= 31 && lz >= m_codec.leading && tz >= m_codec.trailing)
+			valueBits = 2 + (32 - leading - trailing);
+		else
+		{
+			leading = lz;
+			trailing = tz;
+			newWindow = true;
+			valueBits = 2 + 5 + 5 + (32 - leading - trailing);
+		}
+	}
+
+	if (m_codec.bits + timeCodeBits + timePayloadBits + valueBits > getCapacity())
+	{
+		if (!writeBlock(true))
+			return false;
+
+		startBlock(timestamp, value);
+		return true;
+	}
+
+	uint8_t* payload = m_block + HEADER_SIZE;
+	putBits(payload, m_codec.bits, timeCode, timeCodeBits);
+	putBits(payload, m_codec.bits, timePayload, timePayloadBits);
+
+	if (x == 0)
+		putBits(payload, m_codec.bits, 0b0, 1);
+	else if (!newWindow)
+	{
+		putBits(payload, m_codec.bits, 0b10, 2);
+		putBits(payload, m_codec.bits, x >> trailing, 32 - leading - trailing);
+	}
+	else
+	{
+		putBits(payload, m_codec.bits, 0b11, 2);
+		putBits(payload, m_codec.bits, leading, 5);
+		putBits(payload, m_codec.bits, 32 - leading - trailing - 1, 5);
+		putBits(payload, m_codec.bits, x >> trailing, 32 - leading - trailing);
+	}
+
+	m_codec.timestamp = timestamp;
+	m_codec.delta = delta;
+	m_codec.value = bits;
+	m_codec.leading = leading;
+	m_codec.trailing = trailing;
+	m_header.count++;
+	m_header.bits = m_codec.bits;
+	return true;
+}
+
+
+/** Writes the samples appended to the open block since the last write, without sealing it, so that they survive a
+ *  reset. An interrupted flush leaves the previous one intact.
+ *
+ * @return				True if write operation was successful.
+ */
+bool Eeprom24TimeSeries::flush(void)
+{
+	return !m_open || (m_written && m_header.count == m_flushedCount) || writeBlock(false);
+}
+
+
+/** Decodes a block.
+ *
+ * @param block			Block index within the region.
+ * @param samples		Array receiving the samples, oldest first.
+ * @param maxSamples	Size of the array.
+ * @return				Number of samples decoded, 0 for a blank block.
+ */
+uint16_t Eeprom24TimeSeries::readBlock(uint16_t block, Sample* samples, uint16_t maxSamples)
+{
+	if (block >= m_blockCount)
+		return 0;
+
+	uint8_t buffer[m_pageSize];
+	BlockHeader header;
+	if (!loadBlock(block, buffer, &header))
+		return 0;
+
+	return decodeBlock(header, buffer + HEADER_SIZE, samples, maxSamples);
+}
+
+
+/** Reads just the header of a block, e.g. to find blocks by timestamp. Only the header CRC is checked, the payload
+ *  is checked when the block is decoded.
+ *
+ * @param block			Block index within the region.
+ * @param header		Receives the header, with a sequence of 0xFFFFFFFF for a blank or invalid block.
+ * @return				True if read was successful.
+ */
+bool Eeprom24TimeSeries::readBlockHeader(uint16_t block, BlockHeader* header)
+{
+	if (m_open && block == m_head)
+	{
+		*header = m_header;
+		return true;
+	}
+
+	return readHeader(block, header, nullptr);
+}
+
+
+/** Reads the samples of a time range, oldest first. The search for the first block is a binary search; when the
+ *  array fills up, call again with the range starting after the last returned timestamp.
+ *
+ * @param from			Start of the range.
+ * @param to			End of the range, inclusive.
+ * @param samples		Array receiving the samples.
+ * @param maxSamples	Size of the array.
+ * @return				Number of samples returned.
+ */
+uint32_t Eeprom24TimeSeries::query(uint32_t from, uint32_t to, Sample* samples, uint32_t maxSamples)
+{
+	uint16_t stored = getStoredBlocks();
+	uint16_t oldest = getOldestBlock();
+	uint32_t count = 0;
+	uint8_t buffer[m_pageSize];
+
+	for (uint16_t position = findBlock(from); position < stored && count < maxSamples; position++)
+	{
+		BlockHeader header;
+		if (!loadBlock((oldest + position) % m_blockCount, buffer, &header))
+			return count;
+
+		if (header.sequence == 0xFFFFFFFF || header.timestamp > to)
+			break;
+
+		Codec codec;
+		resetCodec(codec, header.timestamp, header.value, header.bits & ~BLOCK_SEALED);
+		Sample sample = {header.timestamp, header.value};
+
+		for (uint16_t i = 0; i < header.count && count < maxSamples; i++)
+		{
+			if (i > 0 && !decodeSample(buffer + HEADER_SIZE, codec, sample))
+				break;
+			if (sample.timestamp > to)
+				return count;
+			if (sample.timestamp >= from)
+				samples[count++] = sample;
+		}
+	}
+
+	return count;
+}
+
+
+bool Eeprom24TimeSeries::getBlockTimestamp(uint16_t block, uint32_t* timestamp)
+{
+	if (m_index)
+	{
+		*timestamp = m_index[block];
+		return true;
+	}
+
+	BlockHeader header;
+	if (!readBlockHeader(block, &header))
+		return false;
+	*timestamp = (header.sequence != 0xFFFFFFFF) ? header.timestamp : NO_TIMESTAMP;
+	return true;
+}
+
+
+/** Finds the last stored block starting at or before a timestamp.
+ *
+ * @return				Position of the block counted from the oldest one, 0 if all blocks start later.
+ */
+uint16_t Eeprom24TimeSeries::findBlock(uint32_t timestamp)
+{
+	uint16_t oldest = getOldestBlock();
+	uint16_t low = 0, high = getStoredBlocks();
+
+	//invariant: blocks before low start at or before the timestamp, blocks from high on start after it
+	while (low < high)
+	{
+		uint16_t middle = low + (high - low) / 2;
+		uint32_t first;
+		if (!getBlockTimestamp((oldest + middle) % m_blockCount, &first))
+			return low;
+
+		if (first <= timestamp)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return (low > 0) ? low - 1 : 0;
+}
+
+
+void Eeprom24TimeSeries::putBits(uint8_t* buffer, uint16_t& position, uint32_t value, uint8_t count)
+{
+	while (count > 0)
+	{
+		count--;
+		uint8_t mask = 0x80 >> (position % 8);
+		if ((value >> count) & 1)
+			buffer[position / 8] |= mask;
+		else
+			buffer[position / 8] &= ~mask;
+		position++;
+	}
+}
+
+
+/** Reads bits at the decoder position; bits beyond the end read as zeros, but still advance the position. */
+uint32_t Eeprom24TimeSeries::getBits(const uint8_t* buffer, Codec& codec, uint8_t count)
+{
+	uint32_t value = 0;
+	while (count > 0)
+	{
+		count--;
+		value <<= 1;
+		if (codec.bits < codec.end)
+			value |= (buffer[codec.bits / 8] >> (7 - codec.bits % 8)) & 1;
+		codec.bits++;
+	}
+	return value;
+}
+
+
+void Eeprom24TimeSeries::resetCodec(Codec& codec, uint32_t timestamp, float value, uint16_t end)
+{
+	codec.timestamp = timestamp;
+	codec.delta = 0;
+	memcpy(&codec.value, &value, sizeof(codec.value));
+	codec.leading = 0xFF;
+	codec.trailing = 0;
+	codec.bits = 0;
+	codec.end = end;
+}
+
+
+/** Decodes the sample following the codec state and advances the state.
+ *
+ * @param payload		Block payload.
+ * @param codec			Decoder state, updated.
+ * @param sample		Receives the sample.
+ * @return				False if the sample runs past the end of the payload or has an impossible XOR window.
+ */
+bool Eeprom24TimeSeries::decodeSample(const uint8_t* payload, Codec& codec, Sample& sample)
+{
+	int32_t dod;
+	if (getBits(payload, codec, 1) == 0)
+		dod = 0;
+	else if (getBits(payload, codec, 1) == 0)
+		dod = (int32_t)getBits(payload, codec, 7) - 63;
+	else if (getBits(payload, codec, 1) == 0)
+		dod = (int32_t)getBits(payload, codec, 9) - 255;
+	else if (getBits(payload, codec, 1) == 0)
+		dod = (int32_t)getBits(payload, codec, 12) - 2047;
+	else
+		dod = (int32_t)getBits(payload, codec, 32);
+
+	codec.delta = (int32_t)((uint32_t)codec.delta + (uint32_t)dod);
+	codec.timestamp += codec.delta;
+
+	if (getBits(payload, codec, 1) != 0)
+	{
+		if (getBits(payload, codec, 1) != 0)
+		{
+			uint8_t leading = getBits(payload, codec, 5);
+			uint8_t size = getBits(payload, codec, 5) + 1;
+			if (leading + size > 32)
+				return false;
+			codec.leading = leading;
+			codec.trailing = 32 - leading - size;
+		}
+		else if (codec.leading > 31)
+			return false;
+
+		codec.value ^= getBits(payload, codec, 32 - codec.leading - codec.trailing) << codec.trailing;
+	}
+
+	sample.timestamp = codec.timestamp;
+	memcpy(&sample.value, &codec.value, sizeof(sample.value));
+	return codec.bits <= codec.end;
+}
+
+
+/** Starts a new open block with the sample stored raw in its header.
+ *
+ */
+void Eeprom24TimeSeries::startBlock(uint32_t timestamp, float value)
+{
+	StoredHeader stored = {m_sequence, timestamp, value};
+	m_header = {m_sequence, timestamp, value, 1, 0};
+	if (m_index)
+		m_index[m_head] = timestamp;
+	resetCodec(m_codec, timestamp, value, getCapacity());
+	memset(m_block, 0, m_pageSize);
+	memcpy(m_block, &stored, sizeof(stored));
+	m_open = true;
+	m_written = false;
+	m_flushedBits = 0;
+	m_flushedCount = 0;
+}
+
+
+/** Writes the open block; a sealed block is closed and the ring advances. The first write of a block writes the
+ *  whole page, later ones the payload bytes from the last flushed bit on and then the commit slot not holding the
+ *  last write.
+ *
+ * @param seal			True if the block is full.
+ * @return				True if write operation was successful.
+ */
+bool Eeprom24TimeSeries::writeBlock(bool seal)
+{
+	uint8_t* payload = m_block + HEADER_SIZE;
+	m_header.bits = m_codec.bits | (seal ? BLOCK_SEALED : 0);
+
+	Commit commit = {m_header.count, m_header.bits, (uint8_t)((m_codec.bits % 8) ? payload[m_codec.bits / 8] : 0), 0, 0, 0};
+	commit.headerCrc = eeprom24Crc16(reinterpret_cast<const uint8_t*>(&commit), offsetof(Commit, headerCrc),
+		eeprom24Crc16(m_block, sizeof(StoredHeader)));
+	commit.payloadCrc = eeprom24Crc16(payload, m_codec.bits / 8);
+
+	uint8_t slot = m_written ? m_slot ^ 1 : 0;
+	uint32_t commitOffset = sizeof(StoredHeader) + slot * sizeof(Commit);
+	memcpy(m_block + commitOffset, &commit, sizeof(commit));
+
+	if (!m_written)
+	{
+		memset(m_block + sizeof(StoredHeader) + sizeof(Commit), 0, sizeof(Commit));
+		if (!m_eeprom.write(getBlockAddress(m_head), m_block, m_pageSize))
+			return false;
+		m_pageWrites++;
+	}
+	else
+	{
+		//the byte holding the last flushed bits is rewritten; its old value is in the tail of the last commit
+		uint16_t first = m_flushedBits / 8, end = (m_codec.bits + 7) / 8;
+		if (end > first)
+		{
+			if (!m_eeprom.write(getBlockAddress(m_head) + HEADER_SIZE + first, payload + first, end - first))
+				return false;
+			m_pageWrites++;
+		}
+
+		if (!m_eeprom.write(getBlockAddress(m_head) + commitOffset, m_block + commitOffset, sizeof(commit)))
+			return false;
+		m_pageWrites++;
+	}
+
+	m_written = true;
+	m_slot = slot;
+	m_flushedBits = m_codec.bits;
+	m_flushedCount = m_header.count;
+
+	if (seal)
+	{
+		m_head = (m_head + 1) % m_blockCount;
+		if (m_head == 0)
+			m_wrapped = true;
+		m_sequence++;
+		m_open = false;
+	}
+
+	return true;
+}
+
+
+/** Decodes the payload of a block.
+ *
+ * @param header		Block header.
+ * @param payload		Block payload.
+ * @param samples		Array receiving the samples, may be null.
+ * @param maxSamples	Size of the array.
+ * @param codec			Receives the decoder state after the last sample, may be null.
+ * @return				Number of samples decoded, 0 for a blank block; less than the count in the header if the
+ * 						payload doesn't decode.
+ */
+uint16_t Eeprom24TimeSeries::decodeBlock(const BlockHeader& header, const uint8_t* payload, Sample* samples, uint16_t maxSamples, Codec* codec)
+{
+	if (header.sequence == 0xFFFFFFFF || header.count == 0)
+		return 0;
+
+	Codec state;
+	resetCodec(state, header.timestamp, header.value, header.bits & ~BLOCK_SEALED);
+	Sample sample = {header.timestamp, header.value};
+	uint16_t count = codec ? header.count : ((header.count < maxSamples) ? header.count : maxSamples);
+	uint16_t i;
+
+	for (i = 0; i < count; i++)
+	{
+		if (i > 0 && !decodeSample(payload, state, sample))
+			break;
+		if (samples && i < maxSamples)
+			samples[i] = sample;
+	}
+
+	if (codec)
+		*codec = state;
+	return i;
+}
+
+
+Eeprom24TimeSeries::Commit Eeprom24TimeSeries::getCommit(const uint8_t* image, uint8_t slot)
+{
+	Commit commit;
+	memcpy(&commit, image + sizeof(StoredHeader) + slot * sizeof(Commit), sizeof(commit));
+	return commit;
+}
+
+
+/** Checks the header CRC of a commit slot and that its counts fit the payload.
+ *
+ * @param image			Block image, at least the header.
+ * @param slot			Commit slot.
+ * @param header		Receives the header.
+ * @return				True if the slot is valid.
+ */
+bool Eeprom24TimeSeries::parseHeader(const uint8_t* image, uint8_t slot, BlockHeader* header) const
+{
+	StoredHeader stored;
+	memcpy(&stored, image, sizeof(stored));
+	Commit commit = getCommit(image, slot);
+
+	uint16_t crc = eeprom24Crc16(reinterpret_cast<const uint8_t*>(&commit), offsetof(Commit, headerCrc),
+		eeprom24Crc16(image, sizeof(StoredHeader)));
+	uint16_t bits = commit.bits & ~BLOCK_SEALED;
+
+	//every sample after the first takes at least two bits
+	if (crc != commit.headerCrc || bits > getCapacity() || commit.count == 0 || (uint32_t)(commit.count - 1) * 2 > bits)
+		return false;
+
+	*header = {stored.sequence, stored.timestamp, stored.value, commit.count, commit.bits};
+	return true;
+}
+
+
+/** Reads the header of a block from the memory and picks the newer valid commit slot. Payload bits only grow within
+ *  a block and the sealed flag is their top bit, so the newer slot is the one with more bits.
+ *
+ * @param block			Block index within the region.
+ * @param header		Receives the header, with a sequence of 0xFFFFFFFF if no slot is valid.
+ * @param slot			Receives the commit slot, may be null.
+ * @return				True if read was successful.
+ */
+bool Eeprom24TimeSeries::readHeader(uint16_t block, BlockHeader* header, uint8_t* slot)
+{
+	uint8_t image[HEADER_SIZE];
+	if (!m_eeprom.read(getBlockAddress(block), image, sizeof(image)))
+		return false;
+
+	header->sequence = 0xFFFFFFFF;
+	BlockHeader candidate;
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		if (parseHeader(image, i, &candidate) && (header->sequence == 0xFFFFFFFF || candidate.bits > header->bits))
+		{
+			*header = candidate;
+			if (slot)
+				*slot = i;
+		}
+	}
+	return true;
+}
+
+
+/** Reads a block and picks the newer commit slot that passes both CRCs; the open block comes from RAM. The tail of
+ *  the commit is put back into the payload.
+ *
+ * @param block			Block index within the region.
+ * @param image			Receives the block, page size.
+ * @param header		Receives the header, with a sequence of 0xFFFFFFFF for a blank or invalid block.
+ * @param slot			Receives the commit slot, may be null.
+ * @return				True if read was successful.
+ */
+bool Eeprom24TimeSeries::loadBlock(uint16_t block, uint8_t* image, BlockHeader* header, uint8_t* slot)
+{
+	if (m_open && block == m_head)
+	{
+		memcpy(image, m_block, m_pageSize);
+		*header = m_header;
+		if (slot)
+			*slot = m_slot;
+		return true;
+	}
+
+	if (!m_eeprom.read(getBlockAddress(block), image, m_pageSize))
+		return false;
+
+	header->sequence = 0xFFFFFFFF;
+	uint8_t valid = 0xFF;
+	BlockHeader candidate;
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		if (!parseHeader(image, i, &candidate) || (header->sequence != 0xFFFFFFFF && candidate.bits <= header->bits))
+			continue;
+
+		uint16_t bits = candidate.bits & ~BLOCK_SEALED;
+		if (eeprom24Crc16(image + HEADER_SIZE, bits / 8) == getCommit(image, i).payloadCrc)
+		{
+			*header = candidate;
+			valid = i;
+		}
+	}
+
+	if (valid == 0xFF)
+		return true;
+
+	uint16_t bits = header->bits & ~BLOCK_SEALED;
+	if (bits % 8)
+		image[HEADER_SIZE + bits / 8] = getCommit(image, valid).tail;
+	if (slot)
+		*slot = valid;
+	return true;
+}
@@ -0,0 +1,146 @@
+/* eeprom24_timeseries.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_TIMESERIES_H_
+#define EEPROM24_TIMESERIES_H_
+
+#include "eeprom24.h"
+#include "eeprom24_crc.h"
+
+/** Compressed log of timestamped float samples, using the Gorilla encoding: timestamps as delta-of-delta with
+ *  variable length codes, values as XOR with the previous value, storing only the meaningful bits. Regular samples of
+ *  a slowly changing signal take a couple of bits each.
+ *
+ *  The region is a ring of page-sized blocks; each block starts with a header holding the first sample raw, so blocks
+ *  decode independently. A block is assembled in RAM and written with a single page write once full; flush() writes
+ *  the open block early. Later writes of the same block only append the new payload bytes and then commit them in
+ *  one of two commit slots, alternately, so the slot holding the last flush is never overwritten. A commit carries a
+ *  CRC of the header and one of the payload, and the partial payload byte, which the next append rewrites; blocks
+ *  and commits failing their CRC, or claiming more samples than the payload can hold, are treated as blank.
+ *
+ *  Blocks are in time order around the ring, so query() binary-searches the first timestamps of the blocks for the
+ *  start of a range and then decodes blocks sequentially: O(log n) header reads instead of a scan of the whole log.
+ *  With setIndex(), the first timestamps are kept in RAM (4 B per block) and the search does no reads at all.
+ */
+class Eeprom24TimeSeries
+{
+public:
+	struct Sample
+	{
+		uint32_t timestamp;
+		float value;
+	};
+
+	struct BlockHeader
+	{
+		uint32_t sequence;		///< increments with every block, 0xFFFFFFFF in blank memory
+		uint32_t timestamp;
+		float value;
+		uint16_t count;
+		uint16_t bits;			///< used payload bits, BLOCK_SEALED set once the block is full
+	};
+
+	Eeprom24TimeSeries(Eeprom24& eeprom, uint32_t address, uint16_t blockCount);
+
+	bool mount(void);
+	bool append(uint32_t timestamp, float value);
+	bool flush(void);
+
+	uint16_t readBlock(uint16_t block, Sample* samples, uint16_t maxSamples);
+	bool readBlockHeader(uint16_t block, BlockHeader* header);
+
+	void setIndex(uint32_t* index) {m_index = index;};
+	uint32_t query(uint32_t from, uint32_t to, Sample* samples, uint32_t maxSamples);
+
+	uint16_t getBlockCount(void) const {return m_blockCount;};
+	uint16_t getOpenBlock(void) const {return m_head;};
+	uint16_t getOldestBlock(void) const {return m_wrapped ? (m_head + 1) % m_blockCount : 0;};
+
+	uint32_t getSamplesAppended(void) const {return m_samplesAppended;};
+	uint32_t getPageWrites(void) const {return m_pageWrites;};
+
+	static constexpr uint16_t BLOCK_SEALED = 0x8000;
+	/** Index entry of a blank or invalid block; sorts after every stored timestamp. */
+	static constexpr uint32_t NO_TIMESTAMP = 0xFFFFFFFF;
+
+protected:
+	/** Start of a block in the memory, written with the first write of the block. */
+	struct StoredHeader
+	{
+		uint32_t sequence;
+		uint32_t timestamp;
+		float value;
+	};
+
+	/** Commit slot; two of them follow the stored header. */
+	struct Commit
+	{
+		uint16_t count;
+		uint16_t bits;
+		uint8_t tail;			///< payload byte holding the last bits, if they don't end at a byte boundary
+		uint8_t reserved;
+		uint16_t headerCrc;		///< over the stored header and the fields above
+		uint16_t payloadCrc;	///< over the whole payload bytes
+	};
+
+public:
+	static constexpr uint8_t HEADER_SIZE = sizeof(StoredHeader) + 2 * sizeof(Commit);
+
+protected:
+	/** Encoder/decoder state, the previous sample and the previous XOR window. */
+	struct Codec
+	{
+		uint32_t timestamp;
+		int32_t delta;
+		uint32_t value;
+		uint8_t leading;
+		uint8_t trailing;
+		uint16_t bits;
+		uint16_t end;			///< payload bits to decode; reading beyond fails the sample
+	};
+
+	static void putBits(uint8_t* buffer, uint16_t& position, uint32_t value, uint8_t count);
+	static uint32_t getBits(const uint8_t* buffer, Codec& codec, uint8_t count);
+	static bool decodeSample(const uint8_t* payload, Codec& codec, Sample& sample);
+	static void resetCodec(Codec& codec, uint32_t timestamp, float value, uint16_t end);
+	static Commit getCommit(const uint8_t* image, uint8_t slot);
+
+	void startBlock(uint32_t timestamp, float value);
+	bool writeBlock(bool seal);
+	bool parseHeader(const uint8_t* image, uint8_t slot, BlockHeader* header) const;
+	bool readHeader(uint16_t block, BlockHeader* header, uint8_t* slot);
+	bool loadBlock(uint16_t block, uint8_t* image, BlockHeader* header, uint8_t* slot = nullptr);
+	uint16_t decodeBlock(const BlockHeader& header, const uint8_t* payload, Sample* samples, uint16_t maxSamples, Codec* codec = nullptr);
+	uint32_t getBlockAddress(uint16_t block) const {return m_address + (uint32_t)block * m_pageSize;};
+	uint16_t getCapacity(void) const {return (m_pageSize - HEADER_SIZE) * 8;};
+	uint16_t getStoredBlocks(void) const {return (m_wrapped ? m_blockCount - 1 : m_head) + (m_open ? 1 : 0);};
+	bool getBlockTimestamp(uint16_t block, uint32_t* timestamp);
+	uint16_t findBlock(uint32_t timestamp);
+
+	Eeprom24& m_eeprom;
+	const uint32_t m_address;
+	const uint16_t m_blockCount;
+	const uint16_t m_pageSize;
+
+	uint8_t m_block[EEPROM24_MAX_PAGE_SIZE];
+	BlockHeader m_header;
+	Codec m_codec;
+	bool m_open = false;
+	bool m_written = false;			///< the open block is in the memory
+	uint8_t m_slot = 0;				///< commit slot of its last write
+	uint16_t m_flushedBits = 0;
+	uint16_t m_flushedCount = 0;
+
+	uint16_t m_head = 0;
+	uint32_t m_sequence = 0;
+	bool m_wrapped = false;
+
+	uint32_t* m_index = nullptr;
+
+	uint32_t m_samplesAppended = 0;
+	uint32_t m_pageWrites = 0;
+};
+
+#endif /* EEPROM24_TIMESERIES_H_ */
@@ -0,0 +1,208 @@
+/* eeprom24_wear.cpp
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#include <string.h>
+#include "eeprom24_wear.h"
+
+
+/** Sets up wear counting for a memory.
+ *
+ * @param eeprom		Memory to count writes of.
+ * @param tableAddress	Where the counter table is kept, getTableSize() bytes.
+ * @param pending		RAM for counts not persisted yet, one entry per page.
+ * @param pendingCount	Number of entries of pending; pages beyond them are not counted.
+ */
+Eeprom24Wear::Eeprom24Wear(Eeprom24& eeprom, uint32_t tableAddress, uint16_t* pending, uint16_t pendingCount):
+	m_eeprom(eeprom), m_tableAddress(tableAddress),
+	m_pageCount((eeprom.getSizeInBytes() / eeprom.getPageSizeInBytes() < pendingCount) ?
+		eeprom.getSizeInBytes() / eeprom.getPageSizeInBytes() : pendingCount),
+	m_pending(pending)
+{
+}
+
+
+/** Loads the operating time; a blank table starts from zero.
+ *
+ * @return				True if the header could be read.
+ */
+bool Eeprom24Wear::mount(void)
+{
+	uint32_t header[2];
+	if (!m_eeprom.read(m_tableAddress, reinterpret_cast<uint8_t*>(header), sizeof(header)))
+		return false;
+
+	m_seconds = (header[0] == MAGIC) ? header[1] : 0;
+	m_lastTick = HAL_GetTick();
+	memset(m_pending, 0, m_pageCount * sizeof(uint16_t));
+	return true;
+}
+
+
+/** Counts a write cycle; called by Eeprom24 after every write transfer.
+ *
+ * @param address		Memory address the write started at.
+ */
+void Eeprom24Wear::onWrite(uint32_t address)
+{
+	uint16_t page = address / m_eeprom.getPageSizeInBytes();
+	if (page >= m_pageCount)
+		return;
+
+	if (m_pending[page] < 0xFFFF)
+		m_pending[page]++;
+	else
+		m_lostWrites++;
+	if (m_pending[page] >= PENDING_LIMIT)
+		m_persistDue = true;
+}
+
+
+/** Adds the RAM counts to the table and updates the operating time. Only table chunks whose codes change are written,
+ *  and the RAM counts of a chunk are only reduced once its write succeeded.
+ *
+ * @return				True if write operation was successful; on false, the counts not written stay pending.
+ */
+bool Eeprom24Wear::persist(void)
+{
+	uint32_t now = HAL_GetTick();
+	uint32_t elapsed = now - m_lastTick;
+	m_seconds += elapsed / 1000;
+	m_lastTick = now - elapsed % 1000;
+	m_persistDue = false;
+
+	for (uint16_t first = 0; first < m_pageCount; first += CHUNK_SIZE)
+	{
+		uint16_t count = (m_pageCount - first > CHUNK_SIZE) ? CHUNK_SIZE : m_pageCount - first;
+		uint16_t codes[CHUNK_SIZE];
+		uint16_t stored[CHUNK_SIZE];
+		bool changed = false;
+
+		if (!m_eeprom.read(getEntryAddress(first), reinterpret_cast<uint8_t*>(codes), count * sizeof(uint16_t)))
+			return failPersist();
+
+		for (uint16_t i = 0; i < count; i++)
+		{
+			stored[i] = 0;
+			uint16_t pending = m_pending[first + i];
+			if (pending == 0)
+				continue;
+
+			//whatever doesn't fill a step of the encoding stays pending
+			uint32_t previous = decode(codes[i]);
+			uint16_t code = encode(previous + pending);
+			stored[i] = decode(code) - previous;
+
+			if (code != codes[i])
+			{
+				codes[i] = code;
+				changed = true;
+			}
+		}
+
+		if (changed && !m_eeprom.write(getEntryAddress(first), reinterpret_cast<const uint8_t*>(codes), count * sizeof(uint16_t)))
+			return failPersist();
+
+		//the write itself may have been counted meanwhile, so take off what went to the table instead of assigning
+		for (uint16_t i = 0; i < count; i++)
+			m_pending[first + i] -= stored[i];
+	}
+
+	uint32_t header[2] = {MAGIC, m_seconds};
+	if (!m_eeprom.write(m_tableAddress, reinterpret_cast<const uint8_t*>(header), sizeof(header)))
+		return failPersist();
+	return true;
+}
+
+
+/** Number of write cycles of a page, including the ones not persisted yet.
+ *
+ */
+uint32_t Eeprom24Wear::getCount(uint16_t page)
+{
+	uint16_t code = BLANK;
+	if (page >= m_pageCount || !m_eeprom.read(getEntryAddress(page), reinterpret_cast<uint8_t*>(&code), sizeof(code)))
+		return 0;
+
+	return decode(code) + m_pending[page];
+}
+
+
+/** Projects the remaining lifetime of a page from its average write rate over the operating time.
+ *
+ * @return				Remaining time in seconds, UINT32_MAX if the page hasn't been written yet.
+ */
+uint32_t Eeprom24Wear::getRemainingLifetime(uint16_t page)
+{
+	uint32_t count = getCount(page);
+	uint32_t seconds = getOperatingTime();
+
+	if (count == 0 || seconds == 0)
+		return UINT32_MAX;
+	if (count >= EEPROM24_ENDURANCE_CYCLES)
+		return 0;
+
+	uint64_t remaining = (uint64_t)(EEPROM24_ENDURANCE_CYCLES - count) * seconds / count;
+	return (remaining > UINT32_MAX) ? UINT32_MAX : remaining;
+}
+
+
+/** Finds the page with the most write cycles; reads the whole table.
+ *
+ * @param count			Receives its write count.
+ * @return				Page index.
+ */
+uint16_t Eeprom24Wear::findMostWorn(uint32_t* count)
+{
+	uint16_t worst = 0;
+	*count = 0;
+
+	for (uint16_t first = 0; first < m_pageCount; first += CHUNK_SIZE)
+	{
+		uint16_t n = (m_pageCount - first > CHUNK_SIZE) ? CHUNK_SIZE : m_pageCount - first;
+		uint16_t codes[CHUNK_SIZE];
+		if (!m_eeprom.read(getEntryAddress(first), reinterpret_cast<uint8_t*>(codes), n * sizeof(uint16_t)))
+			break;
+
+		for (uint16_t i = 0; i < n; i++)
+		{
+			uint32_t value = decode(codes[i]) + m_pending[first + i];
+			if (value > *count)
+			{
+				*count = value;
+				worst = first + i;
+			}
+		}
+	}
+
+	return worst;
+}
+
+
+/** Encodes a count, rounding down: exponent 0 holds 0..4095 directly, exponent e > 0 holds (4096 + mantissa) << (e - 1).
+ *
+ */
+uint16_t Eeprom24Wear::encode(uint32_t count)
+{
+	if (count < 4096)
+		return count;
+
+	uint8_t exponent = (31 - __builtin_clz(count)) - 11;
+	if (exponent > 15)
+		return BLANK - 1;
+
+	uint16_t code = (exponent << 12) | (((count >> (exponent - 1)) - 4096) & 0x0FFF);
+	return (code == BLANK) ? BLANK - 1 : code;
+}
+
+
+uint32_t Eeprom24Wear::decode(uint16_t code)
+{
+	if (code == BLANK)
+		return 0;
+
+	uint8_t exponent = code >> 12;
+	uint32_t mantissa = code & 0x0FFF;
+	return (exponent == 0) ? mantissa : (4096 + mantissa) << (exponent - 1);
+}
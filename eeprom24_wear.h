@@ -0,0 +1,88 @@
+/* eeprom24_wear.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_WEAR_H_
+#define EEPROM24_WEAR_H_
+
+#include "eeprom24.h"
+
+/** Per-page write counters, fed from the write paths of an Eeprom24, with a lifetime projection. New writes are
+ *  counted in RAM; persist() adds them to a table in the memory, 2 bytes per page, in a floating point like encoding
+ *  (12 bit mantissa, 4 bit exponent): exact below 8192, then with a step growing with the count. What doesn't fill a
+ *  step stays in RAM for the next persist(), so no writes are lost to rounding.
+ *
+ *  The table header holds the operating time accumulated by persist(); the remaining lifetime of a page is projected
+ *  from its average write rate over that time.
+ *
+ *  A RAM count is 16 bits. isPersistDue() is raised at PENDING_LIMIT, half way; persist() can't be run from onWrite(),
+ *  which is called inside a write transfer, so it's up to the application to call it in time. Writes to a page whose
+ *  count is already at 0xFFFF are lost from the statistics and counted by getLostWrites().
+ *
+ *  	Eeprom24WearBuffer<512> wear(eeprom, 0xFB00);
+ *  	wear.mount();
+ *  	eeprom.setWearTracker(&wear);
+ *  	...
+ *  	wear.persist();		//e.g. hourly, and whenever isPersistDue()
+ */
+class Eeprom24Wear
+{
+public:
+	Eeprom24Wear(Eeprom24& eeprom, uint32_t tableAddress, uint16_t* pending, uint16_t pendingCount);
+
+	bool mount(void);
+	void onWrite(uint32_t address);
+	bool persist(void);
+	bool isPersistDue(void) const {return m_persistDue;};
+
+	uint32_t getCount(uint16_t page);
+	uint32_t getRemainingLifetime(uint16_t page);
+	uint16_t findMostWorn(uint32_t* count);
+	uint32_t getOperatingTime(void) const {return m_seconds + (HAL_GetTick() - m_lastTick) / 1000;};
+
+	uint16_t getPageCount(void) const {return m_pageCount;};
+	uint32_t getLostWrites(void) const {return m_lostWrites;};
+	uint32_t getTableSize(void) const {return HEADER_SIZE + m_pageCount * sizeof(uint16_t);};
+
+	static uint16_t encode(uint32_t count);
+	static uint32_t decode(uint16_t code);
+
+	static constexpr uint32_t MAGIC = 0x57454152;
+	static constexpr uint8_t HEADER_SIZE = 8;
+	static constexpr uint16_t BLANK = 0xFFFF;
+	static constexpr uint16_t PENDING_LIMIT = 0x8000;
+
+protected:
+	static constexpr uint8_t CHUNK_SIZE = 32;
+
+	uint32_t getEntryAddress(uint16_t page) const {return m_tableAddress + HEADER_SIZE + page * sizeof(uint16_t);};
+	bool failPersist(void) {m_persistDue = true; return false;};
+
+	Eeprom24& m_eeprom;
+	const uint32_t m_tableAddress;
+	const uint16_t m_pageCount;
+	uint16_t* const m_pending;
+
+	uint32_t m_seconds = 0;
+	uint32_t m_lastTick = 0;
+	uint32_t m_lostWrites = 0;
+	bool m_persistDue = false;
+};
+
+
+/** Wear counters together with their RAM storage.
+ *
+ * @tparam PageCount	Number of pages of the memory; with fewer, only the first PageCount pages are counted.
+ */
+template<uint16_t PageCount>
+class Eeprom24WearBuffer: public Eeprom24Wear
+{
+public:
+	Eeprom24WearBuffer(Eeprom24& eeprom, uint32_t tableAddress): Eeprom24Wear(eeprom, tableAddress, m_storage, PageCount) {};
+
+private:
+	uint16_t m_storage[PageCount] = {};
+};
+
+#endif /* EEPROM24_WEAR_H_ */
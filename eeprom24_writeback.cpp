@@ -0,0 +1,387 @@
+/* eeprom24_writeback.cpp
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#include <string.h>
+#include "eeprom24_writeback.h"
+
+
+Eeprom24WriteBack::Eeprom24WriteBack(Eeprom24& eeprom, Line* lines, uint8_t lineCount, uint16_t lineSize, uint8_t policy, uint32_t maxDirtyAge):
+	m_eeprom(eeprom), m_lines(lines), m_lineCount(lineCount),
+	m_lineSize(eeprom.getPageAlignedSize(lineSize)),
+	m_policy(policy), m_maxDirtyAge(maxDirtyAge)
+{
+}
+
+
+/** Stores data in the cache. Never waits for the memory: if no line is free and the memory is busy, the write is
+ *  rejected and the caller should retry after poll() or sync().
+ *
+ * @param address		Address to start writing at.
+ * @param data			Pointer to an array with data to be written.
+ * @param length		How many bytes to write.
+ * @param priority		Importance of the data for emergencyFlush(); a line keeps the highest priority written to it.
+ * @return				True if all data is in the cache; on false, a leading part may have been stored.
+ */
+bool Eeprom24WriteBack::write(uint32_t address, const uint8_t* data, uint32_t length, uint8_t priority)
+{
+	if (address + length > m_eeprom.getSizeInBytes())
+		return false;
+
+	while (length > 0)
+	{
+		uint32_t index = address / m_lineSize;
+		uint16_t offset = address % m_lineSize;
+		uint16_t chunk = m_lineSize - offset;
+		if (chunk > length)
+			chunk = length;
+
+		Line* line = findLine(index);
+		if (line == nullptr)
+			line = allocateLine(index);
+		if (line == nullptr)
+		{
+			//evict the oldest line, but only if that doesn't mean waiting for a write cycle
+			Line* oldest = getOldestLine();
+			if (oldest == nullptr || !m_eeprom.isReady() || !flushLine(*oldest))
+			{
+				m_rejectedWrites++;
+				return false;
+			}
+			line = allocateLine(index);
+		}
+
+		memcpy(&line->data[offset], data, chunk);
+		if (priority > line->priority)
+			line->priority = priority;
+		for (uint16_t i = offset; i < offset + chunk; i++)
+			line->mask[i / 8] |= 1 << (i % 8);
+
+		address += chunk;
+		data += chunk;
+		length -= chunk;
+	}
+
+	return true;
+}
+
+
+/** Reads data from the memory, with cached changes applied on top.
+ *
+ * @param address		Address to start reading at.
+ * @param data			Pointer to an array in which data will be stored.
+ * @param length		How many bytes to read.
+ * @return				True if read was successful.
+ */
+bool Eeprom24WriteBack::read(uint32_t address, uint8_t* data, uint32_t length)
+{
+	if (!m_eeprom.read(address, data, length))
+		return false;
+
+	for (uint8_t i = 0; i < m_lineCount; i++)
+	{
+		Line& line = m_lines[i];
+		if (!line.used)
+			continue;
+
+		uint32_t lineAddress = line.index * m_lineSize;
+		for (uint16_t j = 0; j < m_lineSize; j++)
+		{
+			uint32_t a = lineAddress + j;
+			if (a >= address && a < address + length && (line.mask[j / 8] & (1 << (j % 8))))
+				data[a - address] = line.data[j];
+		}
+	}
+
+	return true;
+}
+
+
+/** Periodic hook; writes at most one line that is due according to the policy, and only if the memory is idle.
+ *
+ * @return				True if a line was written.
+ */
+bool Eeprom24WriteBack::poll(void)
+{
+	if (!(m_policy & (FLUSH_ON_LINE_FULL | FLUSH_ON_AGE)) || getDirtyCount() == 0)
+		return false;
+
+	Line* due = nullptr;
+	uint32_t now = EEPROM24_GET_TIME_US();
+
+	for (uint8_t i = 0; i < m_lineCount && due == nullptr; i++)
+	{
+		Line& line = m_lines[i];
+		if (!line.used)
+			continue;
+
+		if ((m_policy & FLUSH_ON_LINE_FULL) && isLineFull(line))
+			due = &line;
+		else if ((m_policy & FLUSH_ON_AGE) && now - line.dirtySince >= m_maxDirtyAge * 1000)
+			due = &line;
+	}
+
+	//the memory is only probed when there is something to write, so an idle poll stays off the bus
+	return due && m_eeprom.isReady() && flushLine(*due);
+}
+
+
+/** Idle hook; writes the oldest dirty line if the memory is idle.
+ *
+ * @return				True if a line was written.
+ */
+bool Eeprom24WriteBack::onIdle(void)
+{
+	if (!(m_policy & FLUSH_ON_IDLE))
+		return false;
+
+	Line* oldest = getOldestLine();
+	return oldest && m_eeprom.isReady() && flushLine(*oldest);
+}
+
+
+/** Low-voltage warning hook, e.g. from the PVD interrupt; saves as much as fits the remaining time.
+ *
+ * @param budget		Time until the supply fails, in us.
+ * @return				True if all data was written.
+ */
+bool Eeprom24WriteBack::onLowVoltage(uint32_t budget)
+{
+	if (!(m_policy & FLUSH_ON_LOW_VOLTAGE))
+		return false;
+
+	emergencyFlush(budget);
+	return getDirtyCount() == 0;
+}
+
+
+/** Writes dirty lines in order of priority (oldest first on equal priority) for as long as the time budget allows.
+ *  The cost of each line is estimated from the learned write cycle time, lines that wouldn't fit anymore are skipped
+ *  in favour of smaller ones, and the memory is polled without any delays. The write cycle of the last line is
+ *  included in the budget, so everything reported as saved really is in the memory when the budget runs out.
+ *
+ * @param budget		Time available, in us.
+ * @return				Number of lines saved.
+ */
+uint8_t Eeprom24WriteBack::emergencyFlush(uint32_t budget)
+{
+	uint32_t start = EEPROM24_GET_TIME_US();
+	uint8_t saved = 0;
+	bool skipped[m_lineCount];
+	memset(skipped, 0, sizeof(skipped));
+
+	while (true)
+	{
+		Line* next = nullptr;
+		for (uint8_t i = 0; i < m_lineCount; i++)
+		{
+			Line& line = m_lines[i];
+			if (!line.used || skipped[i])
+				continue;
+
+			if (next == nullptr || line.priority > next->priority ||
+				(line.priority == next->priority && (int32_t)(line.dirtySince - next->dirtySince) < 0))
+				next = &line;
+		}
+
+		if (next == nullptr)
+			break;
+
+		uint16_t first;
+		bool gaps;
+		uint16_t length = getDirtySpan(*next, &first, &gaps);
+
+		uint32_t elapsed = EEPROM24_GET_TIME_US() - start;
+		uint32_t cost = m_eeprom.getTimeUntilReady() + m_eeprom.getWriteCost(length);
+		if (gaps)
+			cost += (length + 3) * EEPROM24_BYTE_TIME_US;
+
+		if (elapsed + cost > budget)
+		{
+			skipped[next - m_lines] = true;
+			continue;
+		}
+
+		if (!m_eeprom.spinForReady(budget - elapsed) || !flushLine(*next))
+			break;
+		saved++;
+	}
+
+	uint32_t elapsed = EEPROM24_GET_TIME_US() - start;
+	if (elapsed < budget)
+		m_eeprom.spinForReady(budget - elapsed);
+
+	return saved;
+}
+
+
+/** Durability barrier: writes all dirty lines and waits until the last write cycle finishes. The time it took is
+ *  kept, see getSyncLatency() and getSyncWorstCase().
+ *
+ * @param timeout		Timeout in ms for each write cycle.
+ * @return				True if all data is stored in the memory.
+ */
+bool Eeprom24WriteBack::sync(uint32_t timeout)
+{
+	uint32_t start = EEPROM24_GET_TIME_US();
+	bool retval = true;
+
+	for (Line* line = getOldestLine(); line != nullptr; line = getOldestLine())
+	{
+		if (!m_eeprom.waitForReady(timeout) || !flushLine(*line))
+		{
+			retval = false;
+			break;
+		}
+	}
+
+	if (retval)
+		retval = m_eeprom.waitForReady(timeout);
+
+	m_syncLatency = EEPROM24_GET_TIME_US() - start;
+	if (m_syncLatency > m_syncWorstCase)
+		m_syncWorstCase = m_syncLatency;
+
+	return retval;
+}
+
+
+/** Counts lines holding unwritten data.
+ *
+ * @return				Number of dirty lines.
+ */
+uint8_t Eeprom24WriteBack::getDirtyCount(void) const
+{
+	uint8_t count = 0;
+	for (uint8_t i = 0; i < m_lineCount; i++)
+		count += m_lines[i].used;
+	return count;
+}
+
+
+Eeprom24WriteBack::Line* Eeprom24WriteBack::findLine(uint32_t index)
+{
+	for (uint8_t i = 0; i < m_lineCount; i++)
+	{
+		if (m_lines[i].used && m_lines[i].index == index)
+			return &m_lines[i];
+	}
+	return nullptr;
+}
+
+
+Eeprom24WriteBack::Line* Eeprom24WriteBack::allocateLine(uint32_t index)
+{
+	for (uint8_t i = 0; i < m_lineCount; i++)
+	{
+		Line& line = m_lines[i];
+		if (line.used)
+			continue;
+
+		line.used = true;
+		line.index = index;
+		line.dirtySince = EEPROM24_GET_TIME_US();
+		line.priority = 0;
+		memset(line.mask, 0, (m_lineSize + 7) / 8);
+		return &line;
+	}
+	return nullptr;
+}
+
+
+Eeprom24WriteBack::Line* Eeprom24WriteBack::getOldestLine(void)
+{
+	Line* oldest = nullptr;
+	uint32_t now = EEPROM24_GET_TIME_US();
+
+	for (uint8_t i = 0; i < m_lineCount; i++)
+	{
+		Line& line = m_lines[i];
+		if (line.used && (oldest == nullptr || now - line.dirtySince > now - oldest->dirtySince))
+			oldest = &line;
+	}
+	return oldest;
+}
+
+
+bool Eeprom24WriteBack::isLineFull(const Line& line) const
+{
+	for (uint16_t i = 0; i < m_lineSize; i++)
+	{
+		if (!(line.mask[i / 8] & (1 << (i % 8))))
+			return false;
+	}
+	return true;
+}
+
+
+/** Finds the range of a line that has to be written.
+ *
+ * @param line			Line to check.
+ * @param first			Receives the offset of the first dirty byte.
+ * @param gaps			Receives whether there are clean bytes inside the span.
+ * @return				Length of the span from the first to the last dirty byte, 0 if the line is clean.
+ */
+uint16_t Eeprom24WriteBack::getDirtySpan(const Line& line, uint16_t* first, bool* gaps) const
+{
+	uint16_t last = 0;
+	*first = m_lineSize;
+	*gaps = false;
+
+	for (uint16_t i = 0; i < m_lineSize; i++)
+	{
+		if (line.mask[i / 8] & (1 << (i % 8)))
+		{
+			if (*first == m_lineSize)
+				*first = i;
+			else if (i != last + 1)
+				*gaps = true;
+			last = i;
+		}
+	}
+
+	return (*first == m_lineSize) ? 0 : (last - *first + 1);
+}
+
+
+/** Writes the dirty span of a line with a single page write and frees the line. Clean bytes inside the span are read
+ *  from the memory first. The memory must be ready.
+ *
+ * @param line			Line to write.
+ * @return				True if write operation was successful.
+ */
+bool Eeprom24WriteBack::flushLine(Line& line)
+{
+	uint16_t first;
+	bool gaps;
+	uint16_t length = getDirtySpan(line, &first, &gaps);
+
+	if (length == 0)
+	{
+		line.used = false;
+		return true;
+	}
+
+	uint32_t address = line.index * m_lineSize + first;
+
+	if (gaps)
+	{
+		uint8_t current[length];
+		if (!m_eeprom.readPage(address, current, length))
+			return false;
+
+		for (uint16_t i = first; i < first + length; i++)
+		{
+			if (!(line.mask[i / 8] & (1 << (i % 8))))
+				line.data[i] = current[i - first];
+		}
+	}
+
+	if (!m_eeprom.writePage(address, &line.data[first], length))
+		return false;
+
+	line.used = false;
+	m_lineFlushes++;
+	return true;
+}
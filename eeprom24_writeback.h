@@ -0,0 +1,110 @@
+/* eeprom24_writeback.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_WRITEBACK_H_
+#define EEPROM24_WRITEBACK_H_
+
+#include "eeprom24.h"
+
+/** Write-behind cache over an Eeprom24. write() only touches RAM; dirty lines are written out later by poll(),
+ *  onIdle() or onLowVoltage() according to the flush policy, or by an explicit sync(). Nothing but sync() and
+ *  onLowVoltage() ever waits for the memory, so a control loop calling write() and poll() never blocks on it.
+ *  On a brown-out warning, emergencyFlush() saves as many lines as fit a time budget, most important first.
+ *
+ *  The cache works in lines of the largest divisor of the EEPROM page size that fits the buffer line size, so a line
+ *  never straddles a page boundary and each flush is a single page write.
+ *  Use Eeprom24WriteBackBuffer to get the storage.
+ */
+class Eeprom24WriteBack
+{
+public:
+	/** Flush policy flags; explicit sync() always works. */
+	enum Policy: uint8_t
+	{
+		FLUSH_ON_LINE_FULL = 0x01,		///< a line is written as soon as all of its bytes are dirty
+		FLUSH_ON_AGE = 0x02,			///< a line is written once it has been dirty for maxDirtyAge
+		FLUSH_ON_IDLE = 0x04,			///< onIdle() writes dirty lines
+		FLUSH_ON_LOW_VOLTAGE = 0x08,	///< onLowVoltage() writes everything
+		FLUSH_DEFAULT = 0x0F,
+	};
+
+	struct Line
+	{
+		uint8_t* data;
+		uint8_t* mask;
+		uint32_t index;
+		uint32_t dirtySince;
+		uint8_t priority;
+		bool used;
+	};
+
+	Eeprom24WriteBack(Eeprom24& eeprom, Line* lines, uint8_t lineCount, uint16_t lineSize, uint8_t policy, uint32_t maxDirtyAge);
+
+	bool write(uint32_t address, const uint8_t* data, uint32_t length, uint8_t priority = 0);
+	bool read(uint32_t address, uint8_t* data, uint32_t length);
+
+	bool poll(void);
+	bool onIdle(void);
+	bool onLowVoltage(uint32_t budget = EEPROM24_EMERGENCY_BUDGET_US);
+	bool sync(uint32_t timeout = 100);
+	uint8_t emergencyFlush(uint32_t budget);
+
+	void setPolicy(uint8_t policy) {m_policy = policy;};
+	void setMaxDirtyAge(uint32_t age) {m_maxDirtyAge = age;};
+
+	uint8_t getDirtyCount(void) const;
+	const Eeprom24& getEeprom(void) const {return m_eeprom;};
+	uint32_t getLineFlushes(void) const {return m_lineFlushes;};
+	uint32_t getRejectedWrites(void) const {return m_rejectedWrites;};
+	uint32_t getSyncLatency(void) const {return m_syncLatency;};
+	uint32_t getSyncWorstCase(void) const {return m_syncWorstCase;};
+
+protected:
+	Line* findLine(uint32_t index);
+	Line* allocateLine(uint32_t index);
+	Line* getOldestLine(void);
+	bool isLineFull(const Line& line) const;
+	uint16_t getDirtySpan(const Line& line, uint16_t* first, bool* gaps) const;
+	bool flushLine(Line& line);
+
+	Eeprom24& m_eeprom;
+	Line* const m_lines;
+	const uint8_t m_lineCount;
+	const uint16_t m_lineSize;
+
+	uint8_t m_policy;
+	uint32_t m_maxDirtyAge;
+
+	uint32_t m_lineFlushes = 0;
+	uint32_t m_rejectedWrites = 0;
+	uint32_t m_syncLatency = 0;
+	uint32_t m_syncWorstCase = 0;
+};
+
+
+/** Write-back cache together with its storage.
+ *
+ * @tparam LineCount	Number of cache lines.
+ * @tparam LineSize		Bytes per line; rounded down to a divisor of the EEPROM's page size, so use one (e.g. a power
+ * 						of two) to not waste RAM.
+ */
+template<uint8_t LineCount, uint16_t LineSize>
+class Eeprom24WriteBackBuffer: public Eeprom24WriteBack
+{
+public:
+	Eeprom24WriteBackBuffer(Eeprom24& eeprom, uint8_t policy = FLUSH_DEFAULT, uint32_t maxDirtyAge = 1000):
+		Eeprom24WriteBack(eeprom, m_storage, LineCount, LineSize, policy, maxDirtyAge)
+	{
+		for (uint8_t i = 0; i < LineCount; i++)
+			m_storage[i] = {m_data[i], m_mask[i], 0, 0, 0, false};
+	};
+
+private:
+	Line m_storage[LineCount];
+	uint8_t m_data[LineCount][LineSize];
+	uint8_t m_mask[LineCount][(LineSize + 7) / 8];
+};
+
+#endif /* EEPROM24_WRITEBACK_H_ */
@@ -0,0 +1,220 @@
+/* eeprom24_writequeue.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_WRITEQUEUE_H_
+#define EEPROM24_WRITEQUEUE_H_
+
+#include <atomic>
+#include <string.h>
+#include "eeprom24.h"
+
+/** Bounded, lock-free multi-producer queue of write records in front of an Eeprom24. Any number of tasks (or the other
+ *  core) may submit(); a single worker calls drain(), which merges adjacent records into page writes. Records are
+ *  written in submission order, so there is no reordering within a producer.
+ *
+ * @tparam Capacity		Number of record slots, must be a power of two.
+ * @tparam MaxRecord	Largest record in bytes.
+ */
+template<uint16_t Capacity, uint16_t MaxRecord>
+class Eeprom24WriteQueue
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	Eeprom24WriteQueue(Eeprom24& eeprom): m_eeprom(eeprom)
+	{
+		for (uint32_t i = 0; i < Capacity; i++)
+			m_slots[i].sequence.store(i, std::memory_order_relaxed);
+	};
+
+	bool submit(uint32_t address, const uint8_t* data, uint16_t length);
+	bool submit(uint32_t address, const uint8_t* data, uint16_t length, uint32_t timeout);
+	uint16_t drain(uint16_t maxRecords = Capacity);
+
+	uint32_t getSubmitted(void) const {return m_submitted.load(std::memory_order_relaxed);};
+	uint32_t getRejected(void) const {return m_rejected.load(std::memory_order_relaxed);};
+	uint32_t getPageWrites(void) const {return m_pageWrites;};
+	uint32_t getFailedWrites(void) const {return m_failedWrites;};
+
+private:
+	struct Slot
+	{
+		std::atomic<uint32_t> sequence;
+		uint32_t address;
+		uint16_t length;
+		uint8_t data[MaxRecord];
+	};
+
+	void flush(uint8_t* page);
+
+	Eeprom24& m_eeprom;
+	Slot m_slots[Capacity];
+	std::atomic<uint32_t> m_enqueuePos {0};
+	uint32_t m_dequeuePos = 0;
+
+	std::atomic<uint32_t> m_submitted {0};
+	std::atomic<uint32_t> m_rejected {0};
+	uint32_t m_pageWrites = 0;
+	uint32_t m_failedWrites = 0;
+
+	//run of adjacent bytes collected for the next page write
+	uint32_t m_runStart = 0;
+	uint16_t m_runLength = 0;
+};
+
+
+/** Submits a record without blocking; safe to call from any task or core concurrently.
+ *
+ * @param address		EEPROM address of the record.
+ * @param data			Record data, copied into the queue.
+ * @param length		Record length, up to MaxRecord.
+ * @return				False if the queue is full (backpressure) or the record is too long.
+ */
+template<uint16_t Capacity, uint16_t MaxRecord>
+bool Eeprom24WriteQueue<Capacity, MaxRecord>::submit(uint32_t address, const uint8_t* data, uint16_t length)
+{
+	if (length == 0 || length > MaxRecord)
+		return false;
+
+	uint32_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+	Slot* slot;
+	while (true)
+	{
+		slot = &m_slots[pos & (Capacity - 1)];
+		int32_t diff = (int32_t)(slot->sequence.load(std::memory_order_acquire) - pos);
+
+		if (diff == 0)
+		{
+			if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			m_rejected.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else
+			pos = m_enqueuePos.load(std::memory_order_relaxed);
+	}
+
+	slot->address = address;
+	slot->length = length;
+	memcpy(slot->data, data, length);
+	slot->sequence.store(pos + 1, std::memory_order_release);
+
+	m_submitted.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+
+/** Submits a record, waiting for the worker to free a slot if the queue is full.
+ *
+ * @param address		EEPROM address of the record.
+ * @param data			Record data, copied into the queue.
+ * @param length		Record length, up to MaxRecord.
+ * @param timeout		Timeout in ms.
+ * @return				False if no slot became free before timeout.
+ */
+template<uint16_t Capacity, uint16_t MaxRecord>
+bool Eeprom24WriteQueue<Capacity, MaxRecord>::submit(uint32_t address, const uint8_t* data, uint16_t length, uint32_t timeout)
+{
+	uint32_t start = HAL_GetTick();
+	while (!submit(address, data, length))
+	{
+		if (length == 0 || length > MaxRecord || HAL_GetTick() - start > timeout)
+			return false;
+
+		EEPROM24_DELAY_US(EEPROM24_POLL_INTERVAL_US);
+	}
+
+	return true;
+}
+
+
+/** Worker side: takes records out of the queue and writes them. Adjacent or overlapping records within a page are
+ *  merged into a single page write; must only be called from one task.
+ *
+ * @param maxRecords	Maximum number of records to take in this call.
+ * @return				Number of records taken.
+ */
+template<uint16_t Capacity, uint16_t MaxRecord>
+uint16_t Eeprom24WriteQueue<Capacity, MaxRecord>::drain(uint16_t maxRecords)
+{
+	const uint16_t pageSize = m_eeprom.getPageSizeInBytes();
+	uint8_t page[pageSize];
+	uint16_t taken = 0;
+	m_runLength = 0;
+
+	while (taken < maxRecords)
+	{
+		Slot& slot = m_slots[m_dequeuePos & (Capacity - 1)];
+		if ((int32_t)(slot.sequence.load(std::memory_order_acquire) - (m_dequeuePos + 1)) < 0)
+			break;
+
+		uint32_t address = slot.address;
+		const uint8_t* data = slot.data;
+		uint16_t length = slot.length;
+
+		while (length > 0)
+		{
+			uint16_t offset = address % pageSize;
+			uint16_t chunk = pageSize - offset;
+			if (chunk > length)
+				chunk = length;
+
+			//merge if the piece lies in the run's page and touches the run, otherwise start a new run
+			uint32_t runOffset = m_runStart % pageSize;
+			bool samePage = m_runLength && (address / pageSize == m_runStart / pageSize);
+			if (!samePage || offset > runOffset + m_runLength || offset + chunk < runOffset)
+			{
+				flush(page);
+				m_runStart = address;
+				m_runLength = 0;
+				runOffset = offset;
+			}
+
+			memcpy(&page[offset], data, chunk);
+			uint32_t runEnd = runOffset + m_runLength;
+			if (offset < runOffset)
+				runOffset = offset;
+			if (offset + chunk > runEnd)
+				runEnd = offset + chunk;
+			m_runStart = address - offset + runOffset;
+			m_runLength = runEnd - runOffset;
+
+			address += chunk;
+			data += chunk;
+			length -= chunk;
+		}
+
+		slot.sequence.store(m_dequeuePos + Capacity, std::memory_order_release);
+		m_dequeuePos++;
+		taken++;
+	}
+
+	flush(page);
+	return taken;
+}
+
+
+/** Writes the collected run, if any.
+ *
+ * @param page			Page buffer the run was collected in.
+ */
+template<uint16_t Capacity, uint16_t MaxRecord>
+void Eeprom24WriteQueue<Capacity, MaxRecord>::flush(uint8_t* page)
+{
+	if (m_runLength == 0)
+		return;
+
+	if (m_eeprom.write(m_runStart, &page[m_runStart % m_eeprom.getPageSizeInBytes()], m_runLength))
+		m_pageWrites++;
+	else
+		m_failedWrites++;
+
+	m_runLength = 0;
+}
+
+#endif /* EEPROM24_WRITEQUEUE_H_ */
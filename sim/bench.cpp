@@ -0,0 +1,791 @@
+/* bench.cpp
+ *
+ * Created on: Oct 17, 2026
+ *
+ * Benchmarks of the library layers against Eeprom24Sim. Times marked "sim" are virtual bus time and don't depend on
+ * the host; "host" times are measured on the machine running the benchmark.
+ *
+ * Build from the repository root; sim/ must come first on the include path so its hal_inc.h is used:
+ * 		g++ -std=c++17 -O2 -Isim -I. -o bench sim/bench.cpp sim/eeprom24_sim.cpp eeprom24.cpp eeprom24_bus.cpp \
+ * 			eeprom24_os.cpp eeprom24_wear.cpp eeprom24_writeback.cpp eeprom24_timeseries.cpp eeprom24_lz.cpp \
+ * 			eeprom24_hashtable.cpp
+ *
+ * Add -pthread -DEEPROM24_OS=2 to build it for the pthread OS adapter; "cpu" compares the two builds. The "lfs"
+ * benchmark is built when lfs.h is found: add -I<littlefs>, eeprom24_lfs.cpp and <littlefs>/lfs.c (and
+ * <littlefs>/lfs_util.c for littlefs 2.1 and later).
+ *
+ * Usage:
+ * 		bench [name]		runs one benchmark, or all of them
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+#include "eeprom24_sim.h"
+#include "eeprom24.h"
+#include "eeprom24_bus.h"
+#include "eeprom24_writeback.h"
+#include "eeprom24_persistent.h"
+#include "eeprom24_timeseries.h"
+#include "eeprom24_lz.h"
+#include "eeprom24_hashtable.h"
+#if __has_include("lfs.h")
+#include "eeprom24_lfs.h"
+#endif
+
+//bus the HAL completion callbacks are forwarded to, for the RTOS adapters
+static Eeprom24Bus* s_bus = nullptr;
+
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef* hi2c)
+{
+	(void)hi2c;
+	if (s_bus)
+		s_bus->onTransferComplete();
+}
+
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef* hi2c)
+{
+	(void)hi2c;
+	if (s_bus)
+		s_bus->onTransferComplete();
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c)
+{
+	(void)hi2c;
+	if (s_bus)
+		s_bus->onTransferError();
+}
+
+static double getTime(clockid_t clock)
+{
+	struct timespec ts;
+	clock_gettime(clock, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/** Latency statistics of a set of samples. */
+struct Distribution
+{
+	std::vector<double> samples;
+
+	void add(double sample) {samples.push_back(sample);};
+
+	void print(const char* label, const char* unit)
+	{
+		if (samples.empty())
+		{
+			printf("  %-28s -\n", label);
+			return;
+		}
+
+		std::sort(samples.begin(), samples.end());
+		double sum = 0, squares = 0;
+		for (double s : samples)
+		{
+			sum += s;
+			squares += s * s;
+		}
+		double mean = sum / samples.size();
+		double deviation = sqrt(squares / samples.size() - mean * mean);
+
+		printf("  %-28s min %.0f, mean %.0f, p99 %.0f, max %.0f, stddev %.0f %s\n", label, samples.front(), mean,
+			samples[(size_t)(0.99 * (samples.size() - 1))], samples.back(), deviation, unit);
+	}
+};
+
+
+/*
+ * Latency of another device's reads while an EEPROM is being written
+ */
+
+/** A sensor on the same bus, read on a timer; the read is a 6 byte transfer. */
+struct Sensor
+{
+	Eeprom24Bus* bus;
+	Eeprom24Bus::Client client;
+	Eeprom24Bus::Job job;
+	uint64_t requested;
+	bool pending;
+	bool queued;
+	uint32_t overruns;
+	Distribution latency;
+
+	static constexpr uint8_t ADDRESS = 0x48;
+	static constexpr uint32_t PERIOD_US = 2000;
+
+	static bool read(I2C_HandleTypeDef* i2c, void* context)
+	{
+		Sensor* sensor = static_cast<Sensor*>(context);
+		uint8_t data[6];
+		HAL_StatusTypeDef status = HAL_I2C_Master_Receive(i2c, ADDRESS << 1, data, sizeof(data), 10);
+		sensor->latency.add(Eeprom24Sim::now() - sensor->requested);
+		sensor->pending = false;
+		sensor->queued = false;
+		return status == HAL_OK;
+	}
+
+	/** Queues a requested read on the bus, once. */
+	static void post(Sensor* sensor)
+	{
+		if (sensor->bus == nullptr || !sensor->pending || sensor->queued)
+			return;
+
+		sensor->queued = true;
+		sensor->bus->post(&sensor->client, &sensor->job);
+	}
+
+	static void onTimer(void* context)
+	{
+		Sensor* sensor = static_cast<Sensor*>(context);
+		if (sensor->pending)
+		{
+			sensor->overruns++;
+			return;
+		}
+
+		sensor->requested = Eeprom24Sim::now();
+		sensor->pending = true;
+
+		//with an RTOS, the bus mutex can't be taken from the timer interrupt; the main loop posts the read instead
+#if EEPROM24_OS == EEPROM24_OS_NONE
+		post(sensor);
+#endif
+	}
+};
+
+static void runJitter(bool shared)
+{
+	Eeprom24Sim sim(65536, 128, 2);
+	Eeprom24_512 eeprom(sim.getHandle());
+	Eeprom24Bus bus(sim.getHandle());
+
+	Sensor sensor {};
+	sensor.job = {Sensor::read, &sensor, nullptr};
+	if (shared)
+	{
+		eeprom.setBus(&bus);
+		sensor.bus = &bus;
+		s_bus = &bus;
+	}
+
+	uint8_t page[128];
+	memset(page, 0x5A, sizeof(page));
+	uint64_t start = Eeprom24Sim::now();
+	Eeprom24Sim::setTimer(Sensor::PERIOD_US, Sensor::onTimer, &sensor);
+
+	//the main loop writes pages back to back and serves the sensor in between
+	const uint32_t pages = 2000;
+	for (uint32_t i = 0; i < pages; i++)
+	{
+		eeprom.write((i % 512) * 128, page, sizeof(page));
+
+		if (shared)
+		{
+			Sensor::post(&sensor);
+			bus.runPending();
+		}
+		else if (sensor.pending)
+			Sensor::read(sim.getHandle(), &sensor);
+	}
+	eeprom.waitForReady();
+
+	Eeprom24Sim::setTimer(0, nullptr, nullptr);
+	s_bus = nullptr;
+	double seconds = (Eeprom24Sim::now() - start) / 1e6;
+
+	printf(" %s\n", shared ? "shared bus, occupancy-aware polling" : "no bus manager, sensor read between writes");
+	sensor.latency.print("sensor read latency (sim)", "us");
+	printf("  %-28s %u\n", "missed sensor periods", sensor.overruns);
+	printf("  %-28s %.0f\n", "eeprom pages/s (sim)", pages / seconds);
+	printf("  %-28s %.1f\n", "ready probes per page", (double)sim.getProbes() / pages);
+}
+
+static void benchJitter(void)
+{
+	runJitter(false);
+	runJitter(true);
+}
+
+
+/*
+ * CPU time spent by the writing thread per KB written
+ */
+
+static void runCpu(bool shared)
+{
+	Eeprom24Sim sim(65536, 128, 2);
+	Eeprom24_512 eeprom(sim.getHandle());
+	Eeprom24Bus bus(sim.getHandle());
+	if (shared)
+	{
+		eeprom.setBus(&bus);
+		s_bus = &bus;
+	}
+
+	uint8_t page[128];
+	memset(page, 0xA5, sizeof(page));
+	const uint32_t bytes = 16384;
+	uint32_t failed = 0;
+
+	Eeprom24Sim::setRealTime(true);
+	double cpu = getTime(CLOCK_THREAD_CPUTIME_ID);
+	double wall = getTime(CLOCK_MONOTONIC);
+
+	for (uint32_t address = 0; address < bytes; address += sizeof(page))
+		failed += !eeprom.write(address, page, sizeof(page));
+	failed += !eeprom.waitForReady();
+
+	cpu = getTime(CLOCK_THREAD_CPUTIME_ID) - cpu;
+	wall = getTime(CLOCK_MONOTONIC) - wall;
+	Eeprom24Sim::setRealTime(false);
+	s_bus = nullptr;
+
+	printf("  %-28s %.3f ms CPU per KB, %.0f %% load, %.1f KB/s, %u failed\n", shared ? "through Eeprom24Bus" : "direct",
+		cpu * 1000 / (bytes / 1024), cpu / wall * 100, bytes / 1024 / wall, failed);
+}
+
+static void benchCpu(void)
+{
+#if EEPROM24_OS == EEPROM24_OS_PTHREAD
+	printf(" pthread adapter: interrupt driven bus transfers, sleeping delays\n");
+#else
+	printf(" bare metal: blocking transfers, spinning delays\n");
+#endif
+	runCpu(false);
+	runCpu(true);
+}
+
+
+/*
+ * Lines saved by an emergency flush within the brown-out budget
+ */
+
+static void runEmergency(uint32_t budget, bool calibrated)
+{
+	Eeprom24Sim sim(65536, 128, 2);
+	Eeprom24_512 eeprom(sim.getHandle());
+	uint8_t page[128];
+
+	//a few writes teach the driver the real write cycle time, otherwise EEPROM24_TWR_MAX_US is assumed
+	for (uint32_t i = 0; calibrated && i < 32; i++)
+	{
+		eeprom.write(0x8000, page, sizeof(page));
+		eeprom.waitForReady();
+	}
+
+	static constexpr uint8_t LINES = 16;
+	Eeprom24WriteBackBuffer<LINES, 128> cache(eeprom, Eeprom24WriteBack::FLUSH_ON_LOW_VOLTAGE);
+	for (uint8_t i = 0; i < LINES; i++)
+	{
+		memset(page, i, sizeof(page));
+		cache.write(i * sizeof(page), page, sizeof(page), i % 4);
+	}
+
+	uint64_t start = Eeprom24Sim::now();
+	uint8_t saved = cache.emergencyFlush(budget);
+	uint64_t elapsed = Eeprom24Sim::now() - start;
+
+	//a line is durable if its data is in the array and no write cycle is still running when the supply fails
+	uint8_t durable = 0;
+	for (uint8_t i = 0; i < LINES; i++)
+	{
+		memset(page, i, sizeof(page));
+		durable += (memcmp(&sim.getMemory()[i * sizeof(page)], page, sizeof(page)) == 0);
+	}
+	bool busy = sim.isBusy();
+
+	printf("  %6u us  %-12s %2u saved, %2u in the array, %s, took %llu us\n", budget,
+		calibrated ? "calibrated" : "uncalibrated", saved, durable, busy ? "WRITE CYCLE RUNNING" : "idle",
+		(unsigned long long)elapsed);
+}
+
+static void benchEmergency(void)
+{
+	printf("  16 dirty 128 B lines, tWR 3.5 ms, 400 kHz\n");
+	const uint32_t budgets[] = {5000, 10000, EEPROM24_EMERGENCY_BUDGET_US, 50000};
+	for (uint32_t budget : budgets)
+	{
+		runEmergency(budget, false);
+		runEmergency(budget, true);
+	}
+}
+
+
+/*
+ * Bytes written by diff-on-save against rewriting the whole struct
+ */
+
+/** Device state as an application would keep it: settings, a calibration table and running counters. */
+struct DeviceState
+{
+	uint32_t magic;
+	uint32_t bootCount;
+	float gain[8];
+	float offset[8];
+	char name[32];
+	uint16_t calibration[64];
+	uint32_t runtimeSeconds;
+	uint32_t errorCount;
+	uint8_t reserved[40];
+};
+
+static void runDiff(const char* pattern, void (*update)(DeviceState& state, uint32_t i))
+{
+	Eeprom24Sim sim(65536, 128, 2);
+	Eeprom24_512 eeprom(sim.getHandle());
+	PersistentObject<DeviceState> state(eeprom, 0x0140);
+	state.load();
+	state.save();
+	eeprom.waitForReady();
+	sim.resetCounters();
+
+	const uint32_t saves = 1000;
+	uint32_t bytes = state.getBytesWritten(), pages = state.getPageWrites();
+	uint64_t start = Eeprom24Sim::now();
+
+	for (uint32_t i = 0; i < saves; i++)
+	{
+		update(state.value(), i);
+		state.save();
+	}
+	eeprom.waitForReady();
+
+	bytes = state.getBytesWritten() - bytes;
+	pages = state.getPageWrites() - pages;
+	double full = sizeof(DeviceState);
+	uint32_t fullPages = (0x0140 + sizeof(DeviceState) - 1) / 128 - 0x0140 / 128 + 1;
+
+	printf("  %-26s %6.1f B/save (%4.1f %% of %u B), %.2f page writes/save (whole struct: %u), %5.0f us/save (sim)\n",
+		pattern, (double)bytes / saves, (double)bytes / saves / full * 100, (unsigned)sizeof(DeviceState),
+		(double)pages / saves, fullPages, (double)(Eeprom24Sim::now() - start) / saves);
+}
+
+static void benchDiff(void)
+{
+	runDiff("counter increment", [](DeviceState& state, uint32_t i) {
+		state.runtimeSeconds = i * 60;
+	});
+	runDiff("boot: two counters", [](DeviceState& state, uint32_t i) {
+		state.bootCount = i;
+		state.errorCount += (i % 10 == 0);
+	});
+	runDiff("one gain and its offset", [](DeviceState& state, uint32_t i) {
+		state.gain[i % 8] = 1.0f + i * 0.001f;
+		state.offset[i % 8] = -0.5f + i * 0.001f;
+	});
+	runDiff("recalibration", [](DeviceState& state, uint32_t i) {
+		for (uint32_t j = 0; j < 64; j++)
+			state.calibration[j] = (uint16_t)(i * 31 + j * 7);
+	});
+	runDiff("rename", [](DeviceState& state, uint32_t i) {
+		snprintf(state.name, sizeof(state.name), "sensor-%u", (unsigned)i);
+	});
+	runDiff("everything changes", [](DeviceState& state, uint32_t i) {
+		memset(&state, (uint8_t)(i + 1), sizeof(state));
+	});
+
+	//the baseline: the whole struct written on every change
+	Eeprom24Sim sim(65536, 128, 2);
+	Eeprom24_512 eeprom(sim.getHandle());
+	DeviceState state {};
+	uint64_t start = Eeprom24Sim::now();
+	for (uint32_t i = 0; i < 1000; i++)
+	{
+		state.runtimeSeconds = i * 60;
+		eeprom.write(0x0140, reinterpret_cast<uint8_t*>(&state), sizeof(state));
+	}
+	eeprom.waitForReady();
+	printf("  %-26s %6.1f B/save, %.2f page writes/save, %5.0f us/save (sim)\n", "whole struct (baseline)",
+		(double)sim.getBytesProgrammed() / 1000, (double)sim.getPageWrites() / 1000, (double)(Eeprom24Sim::now() - start) / 1000);
+}
+
+
+/*
+ * Compression ratio and encode/decode speed of the time-series store
+ */
+
+static void runTimeSeries(const char* signal, float (*value)(uint32_t i), uint32_t (*timestamp)(uint32_t i))
+{
+	static constexpr uint16_t BLOCKS = 256;
+	static constexpr uint32_t SAMPLES = 20000;
+	static Eeprom24TimeSeries::Sample samples[SAMPLES];
+
+	Eeprom24Sim sim(65536, 128, 2);
+	Eeprom24_512 eeprom(sim.getHandle());
+	Eeprom24TimeSeries series(eeprom, 0x0000, BLOCKS);
+	series.mount();
+
+	//host time includes the page writes, which the sim doesn't wait for in real time
+	double start = getTime(CLOCK_MONOTONIC);
+	const uint32_t appended = SAMPLES;
+	for (uint32_t i = 0; i < appended; i++)
+		series.append(timestamp(i), value(i));
+	series.flush();
+	eeprom.waitForReady();
+	double encode = getTime(CLOCK_MONOTONIC) - start;
+
+	//the ring keeps BLOCKS - 1 sealed blocks; count what it still holds
+	start = getTime(CLOCK_MONOTONIC);
+	uint64_t simStart = Eeprom24Sim::now();
+	uint32_t stored = series.query(0, 0xFFFFFFFF, samples, SAMPLES);
+	double decode = getTime(CLOCK_MONOTONIC) - start;
+	uint64_t simQuery = Eeprom24Sim::now() - simStart;
+
+	uint32_t errors = 0;
+	uint32_t first = appended - stored;
+	for (uint32_t i = 0; i < stored; i++)
+	{
+		float expected = value(first + i);
+		if (samples[i].timestamp != timestamp(first + i) || memcmp(&samples[i].value, &expected, sizeof(expected)) != 0)
+			errors++;
+	}
+
+	uint16_t blocks = (stored == appended) ? series.getOpenBlock() + 1 : BLOCKS;
+	double bytesPerSample = (double)blocks * 128 / stored;
+	printf("  %-22s %5.2f B/sample (%4.1fx vs 12 B raw), %4.2f page writes/100 samples (raw: %4.2f), "
+		"encode %5.1f Msamples/s, query %5.1f Msamples/s (host), %5.1f us/sample (sim), %u errors\n",
+		signal, bytesPerSample, 12 / bytesPerSample, (double)series.getPageWrites() * 100 / appended,
+		100.0 * 12 / 128, appended / encode / 1e6, stored / decode / 1e6, (double)simQuery / stored, errors);
+}
+
+static void benchTimeSeries(void)
+{
+	printf("  20000 samples, 128 B blocks, flushed only when full; query is a full-range read through the sim\n");
+	runTimeSeries("constant, 1 s", [](uint32_t) {return 21.5f;}, [](uint32_t i) {return i;});
+	runTimeSeries("slow sine, 1 s", [](uint32_t i) {return 20.0f + 5.0f * sinf(i * 0.001f);},
+		[](uint32_t i) {return i;});
+	runTimeSeries("0.1 quantized, 1 s", [](uint32_t i) {return roundf((20.0f + 5.0f * sinf(i * 0.01f)) * 10) / 10;},
+		[](uint32_t i) {return i;});
+	runTimeSeries("slow sine, jittered", [](uint32_t i) {return 20.0f + 5.0f * sinf(i * 0.001f);},
+		[](uint32_t i) {return i * 1000 + (i * 2654435761u >> 28);});
+	runTimeSeries("noise, 1 s", [](uint32_t i) {return (float)((i * 2654435761u) >> 8) / (1 << 24);},
+		[](uint32_t i) {return i;});
+}
+
+
+/*
+ * Range query latency against log size
+ */
+
+static void runQuery(uint16_t blocks)
+{
+	static uint32_t index[512];
+	static Eeprom24TimeSeries::Sample samples[60];
+
+	Eeprom24Sim sim(65536, 128, 2);
+	Eeprom24_512 eeprom(sim.getHandle());
+	Eeprom24TimeSeries series(eeprom, 0x0000, blocks);
+	series.mount();
+
+	//fill all but the open block with 1 s samples of a slowly changing signal
+	uint32_t t = 0;
+	while (series.getOpenBlock() < blocks - 1)
+	{
+		series.append(t, 20.0f + 5.0f * sinf(t * 0.001f));
+		t++;
+	}
+	eeprom.waitForReady();
+
+	//a minute in the middle of the log
+	uint32_t from = t / 2, to = from + 59;
+	uint64_t start = Eeprom24Sim::now();
+	uint32_t found = series.query(from, to, samples, 60);
+	uint64_t search = Eeprom24Sim::now() - start;
+
+	series.setIndex(index);
+	series.mount();
+	start = Eeprom24Sim::now();
+	found += series.query(from, to, samples, 60);
+	uint64_t indexed = Eeprom24Sim::now() - start;
+
+	//the baseline: reading the whole log to find the range
+	uint8_t page[128];
+	start = Eeprom24Sim::now();
+	for (uint16_t i = 0; i < blocks; i++)
+		eeprom.read(i * sizeof(page), page, sizeof(page));
+	uint64_t linear = Eeprom24Sim::now() - start;
+
+	printf("  %4u blocks %7u samples: binary search %6llu us, RAM index %6llu us, linear read %7llu us (sim)%s\n",
+		blocks, t, (unsigned long long)search, (unsigned long long)indexed, (unsigned long long)linear,
+		found == 120 ? "" : ", WRONG RESULT");
+}
+
+static void benchQuery(void)
+{
+	printf("  60 samples from the middle of a full log, 128 B blocks, 400 kHz\n");
+	for (uint16_t blocks = 16; blocks <= 512; blocks *= 2)
+		runQuery(blocks);
+}
+
+
+/*
+ * LZ compression ratio and speed on typical blobs
+ */
+
+static void runLz(const char* kind, const uint8_t* data, uint32_t length)
+{
+	static uint8_t check[32768];
+
+	Eeprom24Sim sim(65536, 128, 2);
+	Eeprom24_512 eeprom(sim.getHandle());
+	Eeprom24LzWriter writer(eeprom, 0x0000, 0x8000);
+
+	//written in pieces, as a blob would be streamed; simulated time includes the write cycles, host time doesn't
+	uint64_t simStart = Eeprom24Sim::now();
+	double start = getTime(CLOCK_MONOTONIC);
+	bool ok = true;
+	for (uint32_t i = 0; i < length; i += 100)
+		ok &= writer.write(data + i, (length - i > 100) ? 100 : length - i);
+	ok &= writer.finish();
+	double compress = getTime(CLOCK_MONOTONIC) - start;
+	eeprom.waitForReady();
+	double save = (Eeprom24Sim::now() - simStart) / 1e3;
+
+	Eeprom24LzReader reader(eeprom, 0x0000);
+	simStart = Eeprom24Sim::now();
+	start = getTime(CLOCK_MONOTONIC);
+	uint32_t read = reader.open() ? reader.read(check, sizeof(check)) : 0;
+	double decompress = getTime(CLOCK_MONOTONIC) - start;
+	double load = (Eeprom24Sim::now() - simStart) / 1e3;
+	ok &= (read == length && memcmp(check, data, length) == 0);
+
+	//the same table stored as is, behind the compressed one
+	simStart = Eeprom24Sim::now();
+	ok &= eeprom.write(0x8000, data, length) && eeprom.waitForReady();
+	double rawSave = (Eeprom24Sim::now() - simStart) / 1e3;
+	simStart = Eeprom24Sim::now();
+	ok &= eeprom.read(0x8000, check, length) && memcmp(check, data, length) == 0;
+	double rawLoad = (Eeprom24Sim::now() - simStart) / 1e3;
+
+	printf("  %-20s %6u B -> %6u B (%5.1f %%), %3u page writes (raw: %3u), compress %6.2f MB/s, decompress %6.2f MB/s "
+		"(host)%s\n", kind, length, writer.getPackedSize(), 100.0 * writer.getPackedSize() / length, writer.getPageWrites(),
+		(length + 127) / 128, length / compress / 1e6, length / decompress / 1e6, ok ? "" : ", ROUND TRIP FAILED");
+	printf("  %-20s save %7.1f ms (raw: %7.1f ms), load %6.1f ms (raw: %6.1f ms) (sim, incl. tWR)\n", "", save, rawSave,
+		load, rawLoad);
+}
+
+static void benchLz(void)
+{
+	static uint8_t data[16384];
+	printf("  window %u B, longest match %u B\n", Eeprom24Lz::WINDOW_SIZE, Eeprom24Lz::MAX_MATCH);
+
+	//configuration text
+	uint32_t length = 0;
+	for (uint32_t i = 0; length + 64 < sizeof(data); i++)
+		length += snprintf(reinterpret_cast<char*>(data) + length, sizeof(data) - length,
+			"sensor[%u].gain=%u.%03u\nsensor[%u].offset=-%u\nsensor[%u].enabled=%s\n", i % 16, 1 + i % 3, i * 37 % 1000,
+			i % 16, i % 50, i % 16, (i % 5) ? "true" : "false");
+	runLz("config text", data, length);
+
+	//binary log records: timestamp, slowly changing values, flags
+	struct Record
+	{
+		uint32_t timestamp;
+		int16_t temperature;
+		uint16_t humidity;
+		uint8_t flags;
+		uint8_t reserved[3];
+	};
+	for (uint32_t i = 0; i < sizeof(data) / sizeof(Record); i++)
+	{
+		Record record = {1700000000 + i * 60, (int16_t)(2150 + 40 * sinf(i * 0.05f)), (uint16_t)(4500 + i % 7), 0x01, {}};
+		memcpy(data + i * sizeof(Record), &record, sizeof(Record));
+	}
+	runLz("binary log records", data, sizeof(data));
+
+	//a mostly blank calibration table
+	memset(data, 0, sizeof(data));
+	for (uint32_t i = 0; i < sizeof(data); i += 97)
+		data[i] = (uint8_t)i;
+	runLz("sparse table", data, sizeof(data));
+
+	//incompressible
+	uint32_t x = 12345;
+	for (uint32_t i = 0; i < sizeof(data); i++)
+	{
+		x = x * 1103515245 + 12345;
+		data[i] = x >> 24;
+	}
+	runLz("random", data, sizeof(data));
+}
+
+
+/*
+ * Bucket reads per lookup and bytes per insert of the hash table
+ */
+
+static void runHashTable(uint32_t percent)
+{
+	static uint8_t bloom[2048];
+	struct Value
+	{
+		uint8_t data[20];
+	};
+
+	Eeprom24Sim sim(65536, 128, 2);
+	Eeprom24_512 eeprom(sim.getHandle());
+	Eeprom24HashTable table(eeprom, 0x0000, 512, sizeof(uint32_t), sizeof(Value));
+	table.setBloomFilter(bloom, sizeof(bloom));
+	table.mount();
+	sim.resetCounters();
+
+	uint32_t records = table.getCapacity() * percent / 100;
+	Value value {};
+	bool ok = true;
+	for (uint32_t i = 0; i < records; i++)
+	{
+		uint32_t key = i * 2654435761u;
+		memcpy(value.data, &key, sizeof(key));
+		ok &= table.put(&key, &value);
+	}
+	eeprom.waitForReady();
+	double bytes = (double)sim.getBytesProgrammed() / records;
+
+	table.resetStats();
+	for (uint32_t i = 0; i < records; i++)
+	{
+		uint32_t key = i * 2654435761u;
+		ok &= table.get(&key, &value) && memcmp(value.data, &key, sizeof(key)) == 0;
+	}
+	double hit = (double)table.getBucketReads() / records;
+
+	table.resetStats();
+	for (uint32_t i = 0; i < records; i++)
+	{
+		uint32_t key = i * 2654435761u + 1;
+		ok &= !table.get(&key, &value);
+	}
+	double miss = (double)table.getBucketReads() / records;
+
+	printf("  load %3u %%: %5.2f bucket reads per hit, %5.2f per miss (Bloom filter, %u of %u skipped), "
+		"%4.1f B programmed per insert%s\n", percent, hit, miss, table.getBloomSkips(), records, bytes, ok ? "" : ", ERRORS");
+}
+
+static void benchHashTable(void)
+{
+	printf("  512 buckets of 5 slots, 4 B keys, 20 B values, 2 KB Bloom filter\n");
+	const uint32_t loads[] = {25, 50, 75, 90};
+	for (uint32_t load : loads)
+		runHashTable(load);
+}
+
+
+#if __has_include("lfs.h")
+/*
+ * File throughput of littlefs on the block device
+ */
+
+static void runLfs(const char* label, uint16_t blockSize, bool syncEachWrite, uint32_t chunk)
+{
+	Eeprom24Sim sim(65536, 128, 2);
+	Eeprom24_512 eeprom(sim.getHandle());
+	Eeprom24Lfs device(eeprom, 0x0000, 65536, blockSize);
+
+	lfs_t lfs;
+	lfs_file_t file;
+	if (lfs_format(&lfs, device.getConfig()) != LFS_ERR_OK || lfs_mount(&lfs, device.getConfig()) != LFS_ERR_OK)
+	{
+		printf("  %-34s FORMAT FAILED\n", label);
+		return;
+	}
+
+	//a 16 KB file written in chunks, as an application would log to it; synced once at the end unless asked otherwise
+	static uint8_t data[4096], check[4096];
+	const uint32_t fileSize = 16384;
+	uint32_t progs = device.getProgs();
+	uint64_t start = Eeprom24Sim::now();
+	bool ok = (lfs_file_open(&lfs, &file, "log", LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC) == LFS_ERR_OK);
+	for (uint32_t i = 0; i < fileSize; i += chunk)
+	{
+		for (uint32_t j = 0; j < chunk; j++)
+			data[j] = (uint8_t)((i + j) * 7);
+		ok &= (lfs_file_write(&lfs, &file, data, chunk) == (lfs_ssize_t)chunk);
+		if (syncEachWrite)
+			ok &= (lfs_file_sync(&lfs, &file) == LFS_ERR_OK);
+	}
+	ok &= (lfs_file_sync(&lfs, &file) == LFS_ERR_OK);
+	uint64_t written = Eeprom24Sim::now() - start;
+	ok &= (lfs_file_close(&lfs, &file) == LFS_ERR_OK);
+	progs = device.getProgs() - progs;
+
+	//read back in the same chunks
+	uint32_t reads = device.getReads();
+	start = Eeprom24Sim::now();
+	ok &= (lfs_file_open(&lfs, &file, "log", LFS_O_RDONLY) == LFS_ERR_OK);
+	for (uint32_t i = 0; i < fileSize; i += chunk)
+	{
+		ok &= (lfs_file_read(&lfs, &file, check, chunk) == (lfs_ssize_t)chunk);
+		for (uint32_t j = 0; j < chunk; j++)
+			ok &= (check[j] == (uint8_t)((i + j) * 7));
+	}
+	uint64_t read = Eeprom24Sim::now() - start;
+	ok &= (lfs_file_close(&lfs, &file) == LFS_ERR_OK);
+	reads = device.getReads() - reads;
+	lfs_unmount(&lfs);
+
+	printf("  %-34s write %5.1f KB/s, read %5.1f KB/s (sim), %u progs, %u reads%s\n", label,
+		fileSize / (written / 1e6) / 1024, fileSize / (read / 1e6) / 1024, progs, reads, ok ? "" : ", ERRORS");
+}
+
+static void benchLfs(void)
+{
+	printf("  16 KB file through lfs_file_write()/lfs_file_read() on a 24LC512 (128 B pages)\n");
+	runLfs("512 B blocks, 512 B writes", 512, false, 512);
+	runLfs("512 B blocks, sync after each write", 512, true, 512);
+	runLfs("512 B blocks, 128 B writes", 512, false, 128);
+	runLfs("4 KB blocks, 4 KB writes", 4096, false, 4096);
+}
+#endif
+
+
+struct Benchmark
+{
+	const char* name;
+	void (*run)(void);
+	const char* description;
+};
+
+static const Benchmark benchmarks[] = {
+	{"jitter", benchJitter, "sensor read latency on a bus shared with a writing EEPROM"},
+	{"cpu", benchCpu, "CPU time per KB written, in host real time"},
+	{"emergency", benchEmergency, "cache lines persisted within a brown-out time budget"},
+	{"diff", benchDiff, "bytes and page writes per diff-on-save for typical updates"},
+	{"timeseries", benchTimeSeries, "compression ratio and encode/query speed of the time-series store"},
+	{"query", benchQuery, "time-series range query latency against log size"},
+	{"lz", benchLz, "LZ compression ratio and speed on typical blobs"},
+	{"hashtable", benchHashTable, "hash table bucket reads per lookup and bytes per insert"},
+#if __has_include("lfs.h")
+	{"lfs", benchLfs, "littlefs file throughput on the block device, pipelined and synced"},
+#endif
+};
+
+
+int main(int argc, char** argv)
+{
+	bool found = false;
+
+	for (const Benchmark& benchmark : benchmarks)
+	{
+		if (argc > 1 && strcmp(argv[1], benchmark.name) != 0)
+			continue;
+
+		printf("%s: %s\n", benchmark.name, benchmark.description);
+		benchmark.run();
+		printf("\n");
+		found = true;
+	}
+
+	if (!found)
+	{
+		fprintf(stderr, "usage: %s [name]\n", argv[0]);
+		for (const Benchmark& benchmark : benchmarks)
+			fprintf(stderr, "  %-12s %s\n", benchmark.name, benchmark.description);
+		return 1;
+	}
+
+	return 0;
+}
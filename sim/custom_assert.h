@@ -0,0 +1,13 @@
+/* custom_assert.h
+ *
+ * Created on: Oct 17, 2026
+ *
+ * Host replacement of the project assert header.
+ */
+
+#ifndef CUSTOM_ASSERT_H_
+#define CUSTOM_ASSERT_H_
+
+#include <assert.h>
+
+#endif /* CUSTOM_ASSERT_H_ */
@@ -0,0 +1,483 @@
+/* eeprom24_sim.cpp
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#include <string.h>
+#include <time.h>
+#include "eeprom24_sim.h"
+#include "eeprom24_config.h"
+
+#if EEPROM24_OS == EEPROM24_OS_PTHREAD
+#include <sched.h>
+#endif
+
+std::atomic<uint64_t> Eeprom24Sim::s_now {0};
+bool Eeprom24Sim::s_realTime = false;
+
+//set while an interrupt driven transfer runs; its bus time is slept through in real time mode
+static thread_local bool s_interruptDriven = false;
+uint32_t Eeprom24Sim::s_timerPeriod = 0;
+uint64_t Eeprom24Sim::s_timerNext = 0;
+void (*Eeprom24Sim::s_timerHandler)(void* context) = nullptr;
+void* Eeprom24Sim::s_timerContext = nullptr;
+
+
+/** Creates a blank (0xFF) device.
+ *
+ * @param size			Size in bytes.
+ * @param pageSize		Page size in bytes.
+ * @param addressBytes	2 for the larger memories; 1 for the smaller ones, which take the upper address bits from the
+ * 						I2C address.
+ * @param timing		Bus and write cycle timing.
+ */
+Eeprom24Sim::Eeprom24Sim(uint32_t size, uint16_t pageSize, uint8_t addressBytes, Timing timing):
+	m_size(size), m_pageSize(pageSize), m_addressBytes(addressBytes), m_timing(timing)
+{
+	m_handle.device = this;
+	m_handle.ErrorCode = HAL_I2C_ERROR_NONE;
+
+	m_memory = new uint8_t[size];
+	m_pageCycles = new uint32_t[size / pageSize];
+	m_byteCycles = new uint32_t[size];
+
+	memset(m_memory, 0xFF, size);
+	resetCounters();
+}
+
+
+Eeprom24Sim::~Eeprom24Sim()
+{
+	delete[] m_memory;
+	delete[] m_pageCycles;
+	delete[] m_byteCycles;
+}
+
+
+uint32_t Eeprom24Sim::getMostWornPage(void) const
+{
+	uint32_t worst = 0;
+	for (uint32_t page = 1; page < m_size / m_pageSize; page++)
+	{
+		if (m_pageCycles[page] > m_pageCycles[worst])
+			worst = page;
+	}
+	return worst;
+}
+
+
+uint32_t Eeprom24Sim::getMostWornByte(void) const
+{
+	uint32_t worst = 0;
+	for (uint32_t address = 1; address < m_size; address++)
+	{
+		if (m_byteCycles[address] > m_byteCycles[worst])
+			worst = address;
+	}
+	return worst;
+}
+
+
+void Eeprom24Sim::resetCounters(void)
+{
+	memset(m_pageCycles, 0, m_size / m_pageSize * sizeof(uint32_t));
+	memset(m_byteCycles, 0, m_size * sizeof(uint32_t));
+	m_pageWrites = 0;
+	m_bytesProgrammed = 0;
+	m_bytesRead = 0;
+	m_probes = 0;
+}
+
+
+/** Moves the virtual time forward, calling the timer handler for every period passed. In real time mode, spins until
+ *  the time has passed, like a CPU waiting for a blocking transfer.
+ *
+ */
+void Eeprom24Sim::advance(uint64_t us)
+{
+	if (s_realTime)
+	{
+		if (s_interruptDriven)
+			sleep(us);
+		else
+			for (uint64_t start = now(); now() - start < us;);
+		return;
+	}
+
+	s_now.fetch_add(us, std::memory_order_relaxed);
+
+	while (s_timerHandler && now() >= s_timerNext)
+	{
+		s_timerNext += s_timerPeriod;
+		s_timerHandler(s_timerContext);
+	}
+}
+
+
+/** Lets time pass without using the CPU; the same as advance() in virtual time.
+ *
+ */
+void Eeprom24Sim::sleep(uint64_t us)
+{
+	if (!s_realTime)
+	{
+		advance(us);
+		return;
+	}
+
+	struct timespec ts = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000};
+	nanosleep(&ts, nullptr);
+}
+
+
+/** Switches between virtual time and the host clock; the virtual time continues from where it was left.
+ *
+ */
+void Eeprom24Sim::setRealTime(bool realTime)
+{
+	if (realTime == s_realTime)
+		return;
+
+	if (realTime)
+		s_now.fetch_sub(getHostTime(), std::memory_order_relaxed);
+	else
+		s_now.fetch_add(getHostTime(), std::memory_order_relaxed);
+	s_realTime = realTime;
+}
+
+
+uint64_t Eeprom24Sim::getHostTime(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+/** Calls a handler every period of virtual time, like a timer interrupt; a null handler stops the timer.
+ *
+ * @param period		Period in us.
+ * @param handler		Called from advance(), i.e. from within any transfer or delay.
+ * @param context		Passed to the handler.
+ */
+void Eeprom24Sim::setTimer(uint32_t period, void (*handler)(void* context), void* context)
+{
+	s_timerPeriod = period;
+	s_timerNext = now() + period;
+	s_timerContext = context;
+	s_timerHandler = (period > 0) ? handler : nullptr;
+}
+
+
+/** A write transfer: sets the address pointer and, if data follows, starts a page write.
+ *
+ */
+HAL_StatusTypeDef Eeprom24Sim::transmit(uint16_t devAddress, const uint8_t* data, uint16_t size)
+{
+	Eeprom24Sim* device = route(devAddress);
+	if (device && device != this)
+		return device->transmit(devAddress, data, size);
+
+	advance(getBusTime(size));
+	if (device == nullptr)
+		return HAL_OK;
+	if (!m_powered || isBusy() || size < m_addressBytes)
+		return HAL_ERROR;
+
+	uint32_t address = getBlockAddress(devAddress);
+	for (uint8_t i = 0; i < m_addressBytes; i++)
+		address = (address << 8) | data[i];
+	address %= m_size;
+	m_pointer = address;
+
+	uint16_t length = size - m_addressBytes;
+	if (length == 0)
+		return HAL_OK;
+
+	//data beyond the page end rolls over to the page start
+	uint32_t page = address - address % m_pageSize;
+	m_pageCycles[page / m_pageSize]++;
+	m_pageWrites++;
+
+	for (uint16_t i = 0; i < length; i++)
+	{
+		uint32_t target = page + (address + i) % m_pageSize;
+
+		if (m_cutArmed && m_cutCountdown == 0)
+		{
+			program(target, random());
+			for (i++; m_cutMode == CUT_UNDEFINED && i < length; i++)
+				program(page + (address + i) % m_pageSize, random());
+
+			m_cutArmed = false;
+			m_powered = false;
+			m_powerCuts++;
+			m_cutAddress = target;
+			m_cutTime = now();
+			return HAL_ERROR;
+		}
+
+		program(target, data[m_addressBytes + i]);
+		if (m_cutArmed)
+			m_cutCountdown--;
+	}
+
+	m_pointer = page + (address + length) % m_pageSize;
+	m_busyUntil = now() + m_timing.writeCycle;
+	return HAL_OK;
+}
+
+
+/** A read transfer from the address pointer; rolls over at the end of the array.
+ *
+ */
+HAL_StatusTypeDef Eeprom24Sim::receive(uint16_t devAddress, uint8_t* data, uint16_t size)
+{
+	Eeprom24Sim* device = route(devAddress);
+	if (device && device != this)
+		return device->receive(devAddress, data, size);
+
+	advance(getBusTime(size));
+	if (device == nullptr)
+	{
+		memset(data, 0, size);
+		return HAL_OK;
+	}
+	if (!m_powered || isBusy())
+		return HAL_ERROR;
+
+	for (uint16_t i = 0; i < size; i++)
+	{
+		data[i] = m_memory[m_pointer];
+		m_pointer = (m_pointer + 1) % m_size;
+	}
+
+	m_bytesRead += size;
+	return HAL_OK;
+}
+
+
+/** Address-only transfer; acknowledged once the write cycle is over.
+ *
+ */
+HAL_StatusTypeDef Eeprom24Sim::probe(uint16_t devAddress)
+{
+	Eeprom24Sim* device = route(devAddress);
+	if (device && device != this)
+		return device->probe(devAddress);
+
+	advance(getBusTime(1));
+	if (device == nullptr)
+		return HAL_OK;
+
+	m_probes++;
+	return (!m_powered || isBusy()) ? HAL_ERROR : HAL_OK;
+}
+
+
+/** Schedules a power loss.
+ *
+ * @param bytes			Number of bytes programmed before the cut; 0 cuts at the first byte of the next page write.
+ * @param mode			What happens to the rest of the interrupted page write.
+ */
+void Eeprom24Sim::armPowerCut(uint32_t bytes, CutMode mode)
+{
+	m_cutArmed = true;
+	m_cutCountdown = bytes;
+	m_cutMode = mode;
+}
+
+
+/** Powers the device up again; an interrupted write cycle is over, the address pointer is reset.
+ *
+ */
+void Eeprom24Sim::powerCycle(void)
+{
+	m_powered = true;
+	m_pointer = 0;
+	m_busyUntil = 0;
+}
+
+
+/** xorshift32; deterministic for a given seed, so a failing run can be repeated.
+ *
+ */
+uint32_t Eeprom24Sim::random(void)
+{
+	m_random ^= m_random << 13;
+	m_random ^= m_random >> 17;
+	m_random ^= m_random << 5;
+	return m_random;
+}
+
+
+void Eeprom24Sim::program(uint32_t address, uint8_t value)
+{
+	m_memory[address] = value;
+	m_byteCycles[address]++;
+	m_bytesProgrammed++;
+}
+
+
+/** Upper address bits of the smaller memories, taken from the block bits of the (shifted) I2C address.
+ *
+ */
+uint32_t Eeprom24Sim::getBlockAddress(uint16_t devAddress) const
+{
+	return (m_addressBytes == 1) ? (devAddress >> 1) & 0b111 : 0;
+}
+
+
+/** Whether a transfer is for this device; the smaller memories respond to all addresses of their blocks.
+ *
+ */
+bool Eeprom24Sim::isAddressed(uint16_t devAddress) const
+{
+	uint8_t blockBits = 0;
+	for (uint32_t blocks = (m_addressBytes == 1) ? m_size / 256 : 1; blocks > 1; blocks >>= 1)
+		blockBits = (blockBits << 1) | 1;
+
+	return (((devAddress >> 1) ^ m_address) & ~blockBits & 0x7F) == 0;
+}
+
+
+/** Device on this bus a transfer is for; null if none of the simulated memories responds to the address.
+ *
+ */
+Eeprom24Sim* Eeprom24Sim::route(uint16_t devAddress)
+{
+	for (Eeprom24Sim* device = this; device != nullptr; device = device->m_next)
+	{
+		if (device->isAddressed(devAddress))
+			return device;
+	}
+	return nullptr;
+}
+
+
+/*
+ * HAL functions, dispatched to the device the handle points to
+ */
+
+static Eeprom24Sim* getDevice(I2C_HandleTypeDef* hi2c)
+{
+	return static_cast<Eeprom24Sim*>(hi2c->device);
+}
+
+static HAL_StatusTypeDef setError(I2C_HandleTypeDef* hi2c, HAL_StatusTypeDef status)
+{
+	hi2c->ErrorCode = (status == HAL_OK) ? HAL_I2C_ERROR_NONE : HAL_I2C_ERROR_AF;
+	return status;
+}
+
+uint32_t HAL_GetTick(void)
+{
+	return Eeprom24Sim::now() / 1000;
+}
+
+void HAL_Delay(uint32_t delay)
+{
+	Eeprom24Sim::advance((uint64_t)delay * 1000);
+}
+
+//reading the timebase costs a microsecond, so loops spinning on it make progress in virtual time
+uint32_t eeprom24SimTimeUs(void)
+{
+	Eeprom24Sim::advance(1);
+	return Eeprom24Sim::now();
+}
+
+//an RTOS delay blocks the task, a bare metal one spins
+void eeprom24SimDelayUs(uint32_t us)
+{
+#if EEPROM24_OS == EEPROM24_OS_PTHREAD
+	Eeprom24Sim::sleep(us);
+	sched_yield();
+#else
+	Eeprom24Sim::advance(us);
+#endif
+}
+
+__attribute__((weak)) void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef* hi2c)
+{
+	(void)hi2c;
+}
+
+__attribute__((weak)) void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef* hi2c)
+{
+	(void)hi2c;
+}
+
+__attribute__((weak)) void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c)
+{
+	(void)hi2c;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef* hi2c, uint16_t devAddress, uint8_t* data, uint16_t size, uint32_t timeout)
+{
+	(void)timeout;
+	return setError(hi2c, getDevice(hi2c)->transmit(devAddress, data, size));
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef* hi2c, uint16_t devAddress, uint8_t* data, uint16_t size, uint32_t timeout)
+{
+	(void)timeout;
+	return setError(hi2c, getDevice(hi2c)->receive(devAddress, data, size));
+}
+
+//interrupt driven transfers complete at once, raising the callback; the state is ready when the caller polls it
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef* hi2c, uint16_t devAddress, uint8_t* data, uint16_t size)
+{
+	s_interruptDriven = true;
+	HAL_StatusTypeDef status = getDevice(hi2c)->transmit(devAddress, data, size);
+	s_interruptDriven = false;
+
+	if (setError(hi2c, status) == HAL_OK)
+		HAL_I2C_MasterTxCpltCallback(hi2c);
+	else
+		HAL_I2C_ErrorCallback(hi2c);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive_IT(I2C_HandleTypeDef* hi2c, uint16_t devAddress, uint8_t* data, uint16_t size)
+{
+	s_interruptDriven = true;
+	HAL_StatusTypeDef status = getDevice(hi2c)->receive(devAddress, data, size);
+	s_interruptDriven = false;
+
+	if (setError(hi2c, status) == HAL_OK)
+		HAL_I2C_MasterRxCpltCallback(hi2c);
+	else
+		HAL_I2C_ErrorCallback(hi2c);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef* hi2c, uint16_t devAddress)
+{
+	(void)hi2c;
+	(void)devAddress;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_IsDeviceReady(I2C_HandleTypeDef* hi2c, uint16_t devAddress, uint32_t trials, uint32_t timeout)
+{
+	(void)timeout;
+
+	for (uint32_t i = 0; i < trials; i++)
+	{
+		if (getDevice(hi2c)->probe(devAddress) == HAL_OK)
+			return HAL_OK;
+	}
+	return HAL_ERROR;
+}
+
+HAL_I2C_StateTypeDef HAL_I2C_GetState(I2C_HandleTypeDef* hi2c)
+{
+	(void)hi2c;
+	return HAL_I2C_STATE_READY;
+}
+
+uint32_t HAL_I2C_GetError(I2C_HandleTypeDef* hi2c)
+{
+	return hi2c->ErrorCode;
+}
@@ -0,0 +1,135 @@
+/* eeprom24_sim.h
+ *
+ * Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROM24_SIM_H_
+#define EEPROM24_SIM_H_
+
+#include <atomic>
+#include "hal_inc.h"
+
+/** Host model of a 24-series EEPROM behind the HAL I2C functions: address pointer, page write with roll-over, busy
+ *  (NACK) during the write cycle, sequential reads rolling over the whole array. Time is virtual and advances by the
+ *  bus time of each transfer and by delays, so a simulated year of writes runs in seconds.
+ *
+ *  Every page write and every programmed byte is counted, for wear and write amplification reports. Transfers to other
+ *  addresses are taken by a generic device on the same bus: they take bus time, are acknowledged and read as zeros.
+ *  More simulated memories can share the handle of the first one with connect(). setTimer() calls a handler
+ *  periodically in virtual time, standing in for a timer interrupt; it is meant for single-threaded runs.
+ *
+ *  Interrupt driven transfers complete within the HAL call and invoke the HAL completion callbacks, which are weak
+ *  and may be overridden. For threaded runs (EEPROM24_OS_PTHREAD), the transfers must be serialized by the caller,
+ *  e.g. by Eeprom24Bus; delays yield the host thread.
+ *
+ *  setRealTime() switches to the host clock, for measuring CPU use: time then really passes, and the caller spins
+ *  through blocking transfers and bare metal delays, but sleeps through interrupt driven transfers and RTOS delays.
+ *
+ *  armPowerCut() injects a power loss at a chosen byte of the upcoming programming: the bytes before it are written,
+ *  the byte at the cut gets a random value and the rest of the page write either keeps the old content or, like a cell
+ *  caught mid-program, random values too. From then on the device doesn't respond until powerCycle().
+ */
+class Eeprom24Sim
+{
+public:
+	enum CutMode: uint8_t
+	{
+		CUT_TORN,			///< bytes after the cut keep their old values
+		CUT_UNDEFINED,		///< bytes after the cut are random
+	};
+
+	struct Timing
+	{
+		uint32_t byteTime;		///< per transferred byte, in us
+		uint32_t writeCycle;	///< tWR in us
+	};
+
+	Eeprom24Sim(uint32_t size, uint16_t pageSize, uint8_t addressBytes, Timing timing = {23, 3500});
+	~Eeprom24Sim();
+
+	I2C_HandleTypeDef* getHandle(void) {return &m_handle;};
+	void setAddress(uint8_t address) {m_address = address;};
+	void connect(Eeprom24Sim* device) {device->m_next = m_next; m_next = device;};
+	uint8_t* getMemory(void) {return m_memory;};
+	uint32_t getSize(void) const {return m_size;};
+	uint16_t getPageSize(void) const {return m_pageSize;};
+
+	uint32_t getPageCycles(uint32_t page) const {return m_pageCycles[page];};
+	uint32_t getByteCycles(uint32_t address) const {return m_byteCycles[address];};
+	uint32_t getMostWornPage(void) const;
+	uint32_t getMostWornByte(void) const;
+	uint64_t getPageWrites(void) const {return m_pageWrites;};
+	uint64_t getBytesProgrammed(void) const {return m_bytesProgrammed;};
+	uint64_t getBytesRead(void) const {return m_bytesRead;};
+	uint64_t getProbes(void) const {return m_probes;};
+	void resetCounters(void);
+
+	void armPowerCut(uint32_t bytes, CutMode mode = CUT_TORN);
+	void disarmPowerCut(void) {m_cutArmed = false;};
+	bool isPowered(void) const {return m_powered;};
+	void powerCycle(void);
+	uint32_t getPowerCuts(void) const {return m_powerCuts;};
+	uint32_t getCutAddress(void) const {return m_cutAddress;};
+	uint64_t getCutTime(void) const {return m_cutTime;};
+
+	void setSeed(uint32_t seed) {m_random = seed ? seed : 1;};
+	uint32_t random(void);
+
+	HAL_StatusTypeDef transmit(uint16_t devAddress, const uint8_t* data, uint16_t size);
+	HAL_StatusTypeDef receive(uint16_t devAddress, uint8_t* data, uint16_t size);
+	HAL_StatusTypeDef probe(uint16_t devAddress);
+	bool isBusy(void) const {return now() < m_busyUntil;};
+
+	static uint64_t now(void) {return s_now.load(std::memory_order_relaxed) + (s_realTime ? getHostTime() : 0);};
+	static void advance(uint64_t us);
+	static void sleep(uint64_t us);
+	static void setRealTime(bool realTime);
+	static void setTimer(uint32_t period, void (*handler)(void* context), void* context);
+
+protected:
+	virtual void program(uint32_t address, uint8_t value);
+	uint32_t getBlockAddress(uint16_t devAddress) const;
+	bool isAddressed(uint16_t devAddress) const;
+	Eeprom24Sim* route(uint16_t devAddress);
+	uint64_t getBusTime(uint16_t bytes) const {return (uint64_t)(bytes + 1) * m_timing.byteTime;};
+
+	static uint64_t getHostTime(void);
+
+	static std::atomic<uint64_t> s_now;
+	static bool s_realTime;
+	static uint32_t s_timerPeriod;
+	static uint64_t s_timerNext;
+	static void (*s_timerHandler)(void* context);
+	static void* s_timerContext;
+
+	I2C_HandleTypeDef m_handle;
+	const uint32_t m_size;
+	const uint16_t m_pageSize;
+	const uint8_t m_addressBytes;
+	const Timing m_timing;
+	uint8_t m_address = 0b1010000;
+	Eeprom24Sim* m_next = nullptr;
+
+	uint8_t* m_memory;
+	uint32_t* m_pageCycles;
+	uint32_t* m_byteCycles;
+
+	uint32_t m_pointer = 0;
+	uint64_t m_busyUntil = 0;
+
+	bool m_powered = true;
+	bool m_cutArmed = false;
+	CutMode m_cutMode = CUT_TORN;
+	uint32_t m_cutCountdown = 0;
+	uint32_t m_powerCuts = 0;
+	uint32_t m_cutAddress = 0;
+	uint64_t m_cutTime = 0;
+	uint32_t m_random = 1;
+
+	uint64_t m_pageWrites = 0;
+	uint64_t m_bytesProgrammed = 0;
+	uint64_t m_bytesRead = 0;
+	uint64_t m_probes = 0;
+};
+
+#endif /* EEPROM24_SIM_H_ */
@@ -0,0 +1,63 @@
+/* hal_inc.h
+ *
+ * Created on: Oct 17, 2026
+ *
+ * Host replacement of the STM32 HAL for the simulators in this directory; the I2C functions are served by Eeprom24Sim
+ * and all time is virtual, so waiting for a write cycle costs no real time.
+ */
+
+#ifndef HAL_INC_H_
+#define HAL_INC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum
+{
+	HAL_OK = 0x00,
+	HAL_ERROR = 0x01,
+	HAL_BUSY = 0x02,
+	HAL_TIMEOUT = 0x03,
+} HAL_StatusTypeDef;
+
+typedef enum
+{
+	HAL_I2C_STATE_RESET = 0x00,
+	HAL_I2C_STATE_READY = 0x20,
+} HAL_I2C_StateTypeDef;
+
+#define HAL_I2C_ERROR_NONE		0x00000000U
+#define HAL_I2C_ERROR_AF		0x00000004U
+
+/** Stands in for the HAL handle; points to the simulated device on the bus. */
+typedef struct
+{
+	void* device;
+	uint32_t ErrorCode;
+} I2C_HandleTypeDef;
+
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t delay);
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef* hi2c, uint16_t devAddress, uint8_t* data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef* hi2c, uint16_t devAddress, uint8_t* data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef* hi2c, uint16_t devAddress, uint8_t* data, uint16_t size);
+HAL_StatusTypeDef HAL_I2C_Master_Receive_IT(I2C_HandleTypeDef* hi2c, uint16_t devAddress, uint8_t* data, uint16_t size);
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef* hi2c, uint16_t devAddress);
+HAL_StatusTypeDef HAL_I2C_IsDeviceReady(I2C_HandleTypeDef* hi2c, uint16_t devAddress, uint32_t trials, uint32_t timeout);
+HAL_I2C_StateTypeDef HAL_I2C_GetState(I2C_HandleTypeDef* hi2c);
+uint32_t HAL_I2C_GetError(I2C_HandleTypeDef* hi2c);
+
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c);
+
+//microsecond virtual timebase for the library
+uint32_t eeprom24SimTimeUs(void);
+void eeprom24SimDelayUs(uint32_t us);
+
+#define EEPROM24_GET_TIME_US()			eeprom24SimTimeUs()
+#define EEPROM24_TIME_RESOLUTION_US		1
+#define EEPROM24_DELAY_US(us)			eeprom24SimDelayUs(us)
+
+#endif /* HAL_INC_H_ */
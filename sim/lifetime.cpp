@@ -0,0 +1,306 @@
+/* lifetime.cpp
+ *
+ * Created on: Oct 17, 2026
+ *
+ * Host simulation of EEPROM lifetime under a write workload. A synthetic sensor workload (or a recorded trace) is run
+ * through Eeprom24 and one of the storage layouts on top of it, against Eeprom24Sim; every page write and programmed
+ * byte is counted, and the hottest page gives the projected years to failure.
+ *
+ * Build from the repository root; sim/ must come first on the include path so its hal_inc.h is used:
+ * 		g++ -std=c++17 -O2 -Isim -I. -o lifetime sim/lifetime.cpp sim/eeprom24_sim.cpp eeprom24.cpp eeprom24_bus.cpp \
+ * 			eeprom24_os.cpp eeprom24_wear.cpp eeprom24_writeback.cpp eeprom24_timeseries.cpp eeprom24_rrd.cpp
+ *
+ * Usage:
+ * 		lifetime <layout> [period_ms] [operations]
+ * 		lifetime trace <file> [direct|writeback]
+ *
+ * Layouts: record, field, writeback, log, timeseries, rrd. A trace has one write per line: "time_ms address length".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include "eeprom24_sim.h"
+#include "eeprom24.h"
+#include "eeprom24_persistent.h"
+#include "eeprom24_writeback.h"
+#include "eeprom24_timeseries.h"
+#include "eeprom24_rrd.h"
+
+/** Settings-like record, updated as a whole or field by field. */
+struct Record
+{
+	uint32_t timestamp;
+	float value;
+	uint32_t counter;
+	uint8_t reserved[20];
+};
+
+/** Simulated device and the report collected from it. */
+struct Run
+{
+	Eeprom24Sim sim {65536, 128, 2};
+	Eeprom24_512 eeprom {sim.getHandle()};
+
+	uint64_t operations = 0;
+	uint64_t appBytes = 0;
+	uint64_t lastTimeMs = 0;
+	uint32_t failures = 0;
+
+	/** Moves the virtual clock to the time of the next operation; the device clock may already be ahead. */
+	void at(uint64_t timeMs)
+	{
+		uint64_t us = timeMs * 1000;
+		if (us > Eeprom24Sim::now())
+			Eeprom24Sim::advance(us - Eeprom24Sim::now());
+		lastTimeMs = timeMs;
+	}
+
+	void count(bool ok, uint32_t bytes)
+	{
+		operations++;
+		appBytes += bytes;
+		if (!ok)
+			failures++;
+	}
+};
+
+static float sample(uint64_t i)
+{
+	return 20.0f + 5.0f * sinf(i * 0.001f) + (i % 7) * 0.01f;
+}
+
+
+static void runRecord(Run& run, uint32_t period, uint64_t operations)
+{
+	Record record {};
+	for (uint64_t i = 0; i < operations; i++)
+	{
+		run.at(i * period);
+		record.timestamp = i * period / 1000;
+		record.value = sample(i);
+		record.counter++;
+		run.count(run.eeprom.write(0x0000, reinterpret_cast<uint8_t*>(&record), sizeof(record)), 12);
+	}
+}
+
+
+static void runField(Run& run, uint32_t period, uint64_t operations)
+{
+	Persistent<Record, 0x0000> record(run.eeprom);
+	record.load();
+
+	for (uint64_t i = 0; i < operations; i++)
+	{
+		run.at(i * period);
+		bool ok = record.set<EEPROM24_MEMBER(Record, timestamp)>(i * period / 1000);
+		ok &= record.set<EEPROM24_MEMBER(Record, value)>(sample(i));
+		ok &= record.set<EEPROM24_MEMBER(Record, counter)>(i);
+		run.count(ok, 12);
+	}
+}
+
+
+static void runWriteBack(Run& run, uint32_t period, uint64_t operations)
+{
+	//lines are written once full or after a minute, whichever comes first
+	static Eeprom24WriteBackBuffer<4, 128> cache(run.eeprom, Eeprom24WriteBack::FLUSH_ON_LINE_FULL | Eeprom24WriteBack::FLUSH_ON_AGE, 60000);
+	Record record {};
+
+	for (uint64_t i = 0; i < operations; i++)
+	{
+		run.at(i * period);
+		record.timestamp = i * period / 1000;
+		record.value = sample(i);
+		record.counter++;
+		run.count(cache.write(0x0000, reinterpret_cast<uint8_t*>(&record), 12), 12);
+		cache.poll();
+	}
+	cache.sync();
+}
+
+
+static void runLog(Run& run, uint32_t period, uint64_t operations)
+{
+	const uint32_t entries = run.eeprom.getSizeInBytes() / 8;
+	for (uint64_t i = 0; i < operations; i++)
+	{
+		run.at(i * period);
+		uint32_t entry[2] = {(uint32_t)(i * period / 1000), 0};
+		float value = sample(i);
+		memcpy(&entry[1], &value, sizeof(value));
+		run.count(run.eeprom.write((i % entries) * 8, reinterpret_cast<uint8_t*>(entry), sizeof(entry)), 8);
+	}
+}
+
+
+static void runTimeSeries(Run& run, uint32_t period, uint64_t operations)
+{
+	static Eeprom24TimeSeries series(run.eeprom, 0x0000, run.eeprom.getSizeInBytes() / run.eeprom.getPageSizeInBytes());
+	series.mount();
+
+	for (uint64_t i = 0; i < operations; i++)
+	{
+		run.at(i * period);
+		run.count(series.append(i * period / 1000, sample(i)), 8);
+	}
+	series.flush();
+}
+
+
+static Eeprom24Rrd::Tier makeTier(uint32_t address, uint32_t slotCount, uint32_t step, Eeprom24Rrd::Consolidation function)
+{
+	Eeprom24Rrd::Tier tier {};
+	tier.address = address;
+	tier.slotCount = slotCount;
+	tier.step = step;
+	tier.function = function;
+	return tier;
+}
+
+
+static void runRrd(Run& run, uint32_t period, uint64_t operations)
+{
+	//two days of minutes, a month of hours, a year of days; timestamps in seconds
+	static Eeprom24Rrd::Tier tiers[] = {
+		makeTier(0x0080, 2880, 60, Eeprom24Rrd::AVERAGE),
+		makeTier(0x2D80, 768, 3600, Eeprom24Rrd::AVERAGE),
+		makeTier(0x3A80, 384, 86400, Eeprom24Rrd::MAXIMUM),
+	};
+	static Eeprom24Rrd rrd(run.eeprom, 0x0000, tiers, sizeof(tiers) / sizeof(tiers[0]));
+	rrd.mount();
+
+	for (uint64_t i = 0; i < operations; i++)
+	{
+		uint64_t time = i * period;
+		run.at(time);
+		bool ok = rrd.update(time / 1000, sample(i));
+
+		//progress header once an hour
+		if (time / 3600000 != (time + period) / 3600000)
+			ok &= rrd.flush();
+		run.count(ok, 8);
+	}
+	rrd.flush();
+}
+
+
+static bool runTrace(Run& run, const char* path, bool writeBack)
+{
+	FILE* file = fopen(path, "r");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "cannot open %s\n", path);
+		return false;
+	}
+
+	static Eeprom24WriteBackBuffer<8, 128> cache(run.eeprom, Eeprom24WriteBack::FLUSH_ON_LINE_FULL | Eeprom24WriteBack::FLUSH_ON_AGE, 60000);
+	uint8_t data[256];
+	unsigned long long time;
+	unsigned long address, length;
+
+	while (fscanf(file, "%llu %lu %lu", &time, &address, &length) == 3)
+	{
+		if (length > sizeof(data) || address + length > run.eeprom.getSizeInBytes())
+			continue;
+
+		run.at(time);
+		memset(data, (uint8_t)run.operations, length);
+		if (writeBack)
+		{
+			run.count(cache.write(address, data, length), length);
+			cache.poll();
+		}
+		else
+			run.count(run.eeprom.write(address, data, length), length);
+	}
+
+	if (writeBack)
+		cache.sync();
+	fclose(file);
+	return true;
+}
+
+
+static void report(const Run& run, const char* layout, double hostSeconds)
+{
+	const Eeprom24Sim& sim = run.sim;
+	double seconds = run.lastTimeMs / 1000.0;
+	uint32_t page = sim.getMostWornPage();
+	uint32_t byte = sim.getMostWornByte();
+	uint32_t cycles = sim.getPageCycles(page);
+
+	printf("layout               %s\n", layout);
+	printf("operations           %llu (%u failed)\n", (unsigned long long)run.operations, run.failures);
+	printf("simulated time       %.1f days\n", seconds / 86400);
+	printf("application bytes    %llu\n", (unsigned long long)run.appBytes);
+	printf("page writes          %llu\n", (unsigned long long)sim.getPageWrites());
+	printf("bytes programmed     %llu\n", (unsigned long long)sim.getBytesProgrammed());
+	printf("write amplification  %.2f (bytes), %.2f (pages)\n",
+		run.appBytes ? (double)sim.getBytesProgrammed() / run.appBytes : 0.0,
+		run.appBytes ? (double)sim.getPageWrites() * sim.getPageSize() / run.appBytes : 0.0);
+	printf("hottest page         %lu, %lu cycles\n", (unsigned long)page, (unsigned long)cycles);
+	printf("hottest byte         0x%04lX, %lu cycles\n", (unsigned long)byte, (unsigned long)sim.getByteCycles(byte));
+
+	//the page is the unit the cells are programmed in, so its count is what wears out
+	if (cycles && seconds > 0)
+		printf("years to failure     %.2f (%u cycles)\n", EEPROM24_ENDURANCE_CYCLES / (cycles / seconds) / 31557600.0, EEPROM24_ENDURANCE_CYCLES);
+	else
+		printf("years to failure     -\n");
+
+	printf("host speed           %.2f Mops/s\n", hostSeconds > 0 ? run.operations / hostSeconds / 1e6 : 0.0);
+}
+
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s <record|field|writeback|log|timeseries|rrd> [period_ms] [operations]\n", argv[0]);
+		fprintf(stderr, "       %s trace <file> [direct|writeback]\n", argv[0]);
+		return 1;
+	}
+
+	static Run run;
+	const char* layout = argv[1];
+	uint32_t period = (argc > 2) ? strtoul(argv[2], nullptr, 0) : 1000;
+	uint64_t operations = (argc > 3) ? strtoull(argv[3], nullptr, 0) : 1000000;
+
+	if (!run.eeprom.init())
+	{
+		fprintf(stderr, "device not responding\n");
+		return 1;
+	}
+	run.sim.resetCounters();
+
+	auto start = std::chrono::steady_clock::now();
+
+	if (strcmp(layout, "record") == 0)
+		runRecord(run, period, operations);
+	else if (strcmp(layout, "field") == 0)
+		runField(run, period, operations);
+	else if (strcmp(layout, "writeback") == 0)
+		runWriteBack(run, period, operations);
+	else if (strcmp(layout, "log") == 0)
+		runLog(run, period, operations);
+	else if (strcmp(layout, "timeseries") == 0)
+		runTimeSeries(run, period, operations);
+	else if (strcmp(layout, "rrd") == 0)
+		runRrd(run, period, operations);
+	else if (strcmp(layout, "trace") == 0 && argc > 2)
+	{
+		if (!runTrace(run, argv[2], argc > 3 && strcmp(argv[3], "writeback") == 0))
+			return 1;
+	}
+	else
+	{
+		fprintf(stderr, "unknown layout %s\n", layout);
+		return 1;
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	report(run, layout, elapsed.count());
+	return 0;
+}
@@ -0,0 +1,819 @@
+/* powerloss.cpp
+ *
+ * Created on: Oct 17, 2026
+ *
+ * Power-loss torture test of the stores built on Eeprom24. Each iteration powers the simulated device up, mounts the
+ * store from whatever the previous cut left behind, checks its invariants against a model of what was acknowledged,
+ * and runs the workload until the power is cut again at a random byte of some page write. A share of the cuts hits
+ * the recovery itself. Mount time (simulated bus time) is collected into a distribution.
+ *
+ * Build from the repository root; sim/ must come first on the include path so its hal_inc.h is used:
+ * 		g++ -std=c++17 -O2 -Isim -I. -o powerloss sim/powerloss.cpp sim/eeprom24_sim.cpp eeprom24.cpp eeprom24_bus.cpp \
+ * 			eeprom24_os.cpp eeprom24_wear.cpp eeprom24_journal.cpp eeprom24_blob.cpp eeprom24_timeseries.cpp \
+ * 			eeprom24_schema.cpp
+ *
+ * Usage:
+ * 		powerloss <journal|journal-pairs|blob|timeseries|schema|all> [iterations] [seed]
+ *
+ * Exits with 2 if any invariant failed, so that a failing store fails the run; "all" runs every store in turn, each
+ * from blank memory and the same seed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "eeprom24_sim.h"
+#include "eeprom24.h"
+#include "eeprom24_journal.h"
+#include "eeprom24_blob.h"
+#include "eeprom24_timeseries.h"
+#include "eeprom24_schema.h"
+
+/** A store under test. The object lives across power cuts and holds the model of the acknowledged state; the store
+ *  itself is RAM state of the device, so it is built anew by attach() after every power-up.
+ */
+class Scenario
+{
+public:
+	Scenario(Eeprom24Sim& sim): m_sim(sim) {};
+	virtual ~Scenario() {};
+
+	virtual const char* getName(void) const = 0;
+	virtual void attach(Eeprom24& eeprom) = 0;
+	virtual bool mount(void) = 0;
+	virtual bool check(void) = 0;
+	virtual void step(void) = 0;
+
+	/** Starts over from blank memory after a failed check, so that each failure is counted once. */
+	virtual void reset(void) = 0;
+
+	/** Bytes programmed by a typical step, the range the cut is placed in. */
+	virtual uint32_t getWindow(void) const = 0;
+
+	const char* getError(void) const {return m_error;};
+
+protected:
+	bool fail(const char* format, ...)
+	{
+		va_list args;
+		va_start(args, format);
+		vsnprintf(m_error, sizeof(m_error), format, args);
+		va_end(args);
+		return false;
+	}
+
+	void erase(uint32_t address, uint32_t length)
+	{
+		memset(m_sim.getMemory() + address, 0xFF, length);
+	}
+
+	Eeprom24Sim& m_sim;
+	char m_error[128] = "";
+};
+
+
+/** Three records, one of them across a page boundary, updated together in journal transactions. All must hold the
+ *  same counter: the last committed one, or the one being committed when the power went.
+ */
+class JournalScenario: public Scenario
+{
+public:
+	using Scenario::Scenario;
+
+	const char* getName(void) const override {return "journal";};
+	uint32_t getWindow(void) const override {return 6 * 128;};
+
+	void attach(Eeprom24& eeprom) override
+	{
+		m_eeprom = &eeprom;
+		m_journal.reset(new Eeprom24Journal(eeprom, 0x0000, 4, m_targets));
+	}
+
+	bool mount(void) override
+	{
+		return m_journal->mount();
+	}
+
+	bool check(void) override
+	{
+		uint32_t value = 0;
+		for (uint8_t r = 0; r < RECORD_COUNT; r++)
+		{
+			uint32_t record[4];
+			if (!m_eeprom->read(ADDRESSES[r], reinterpret_cast<uint8_t*>(record), sizeof(record)))
+				return fail("read failed");
+
+			for (uint8_t i = 0; i < 4; i++)
+			{
+				if (r == 0 && i == 0)
+					value = record[0];
+				else if (record[i] != value)
+					return fail("records differ: %08X vs %08X", record[i], value);
+			}
+		}
+
+		if (value != m_committed && !(m_pending && value == m_committed + 1))
+			return fail("counter %u, committed %u%s", value, m_committed, m_pending ? " (commit pending)" : "");
+
+		m_committed = value;
+		m_pending = false;
+		return true;
+	}
+
+	void step(void) override
+	{
+		uint32_t record[4];
+		for (uint8_t i = 0; i < 4; i++)
+			record[i] = m_committed + 1;
+
+		if (!m_journal->begin())
+			return;
+		for (uint8_t r = 0; r < RECORD_COUNT; r++)
+		{
+			if (!m_journal->write(ADDRESSES[r], reinterpret_cast<uint8_t*>(record), sizeof(record)))
+				return;
+		}
+
+		m_pending = true;
+		if (m_journal->commit())
+		{
+			m_committed++;
+			m_pending = false;
+		}
+	}
+
+	void reset(void) override
+	{
+		erase(0x0000, 5 * 128);
+		for (uint8_t r = 0; r < RECORD_COUNT; r++)
+			erase(ADDRESSES[r], 16);
+		m_committed = 0xFFFFFFFF;
+		m_pending = false;
+	}
+
+private:
+	static constexpr uint8_t RECORD_COUNT = 3;
+	static constexpr uint32_t ADDRESSES[RECORD_COUNT] = {0x1000, 0x2040, 0x30F8};
+
+	Eeprom24* m_eeprom = nullptr;
+	std::unique_ptr<Eeprom24Journal> m_journal;
+	uint16_t m_targets[4];
+
+	//blank memory reads as 0xFFFFFFFF, the counter starts there and wraps to 0 with the first commit
+	uint32_t m_committed = 0xFFFFFFFF;
+	bool m_pending = false;
+};
+
+constexpr uint32_t JournalScenario::ADDRESSES[];
+
+
+/** Transactions alternating between two pairs of records on different pages, one record across a page boundary.
+ *  Each record holds its own index next to the number of the transaction that wrote it, so a commit replayed with
+ *  the targets of an earlier transaction shows up as data in the wrong record. A pair must hold the number of its
+ *  last committed transaction, or both records that of the one being committed when the power went.
+ */
+class JournalPairsScenario: public Scenario
+{
+public:
+	using Scenario::Scenario;
+
+	const char* getName(void) const override {return "journal-pairs";};
+	uint32_t getWindow(void) const override {return 8 * 128;};
+
+	void attach(Eeprom24& eeprom) override
+	{
+		m_eeprom = &eeprom;
+		m_journal.reset(new Eeprom24Journal(eeprom, 0x0000, 4, m_targets));
+	}
+
+	bool mount(void) override
+	{
+		return m_journal->mount();
+	}
+
+	bool check(void) override
+	{
+		uint32_t values[RECORD_COUNT];
+		for (uint8_t r = 0; r < RECORD_COUNT; r++)
+		{
+			uint32_t record[4];
+			if (!m_eeprom->read(ADDRESSES[r], reinterpret_cast<uint8_t*>(record), sizeof(record)))
+				return fail("read failed");
+
+			values[r] = record[0];
+			if (record[0] == 0xFFFFFFFF && record[1] == 0xFFFFFFFF)
+				continue;
+			if (record[1] != r || record[2] != record[0] || record[3] != r)
+				return fail("record %u holds %08X %08X %08X %08X", r, record[0], record[1], record[2], record[3]);
+		}
+
+		bool applied = false;
+		for (uint8_t r = 0; r < RECORD_COUNT; r++)
+		{
+			bool pending = m_pending && r / 2 == m_transaction % 2;
+			if (pending && values[r] == m_transaction)
+				applied = true;
+			else if (values[r] != m_values[r])
+				return fail("record %u is at transaction %u, committed %u", r, values[r], m_values[r]);
+		}
+
+		if (applied)
+		{
+			uint8_t first = (m_transaction % 2) * 2;
+			if (values[first] != values[first + 1])
+				return fail("records %u and %u are at transactions %u and %u", first, first + 1, values[first], values[first + 1]);
+			m_values[first] = m_values[first + 1] = m_transaction;
+		}
+
+		m_pending = false;
+		return true;
+	}
+
+	void step(void) override
+	{
+		uint32_t transaction = m_transaction + 1;
+		uint8_t first = (transaction % 2) * 2;
+
+		if (!m_journal->begin())
+			return;
+		for (uint8_t r = first; r < first + 2; r++)
+		{
+			uint32_t record[4] = {transaction, r, transaction, r};
+			if (!m_journal->write(ADDRESSES[r], reinterpret_cast<uint8_t*>(record), sizeof(record)))
+				return;
+		}
+
+		m_transaction = transaction;
+		m_pending = true;
+		if (m_journal->commit())
+		{
+			m_values[first] = m_values[first + 1] = transaction;
+			m_pending = false;
+		}
+	}
+
+	void reset(void) override
+	{
+		erase(0x0000, 5 * 128);
+		for (uint8_t r = 0; r < RECORD_COUNT; r++)
+		{
+			erase(ADDRESSES[r], 16);
+			m_values[r] = 0xFFFFFFFF;
+		}
+		m_transaction = 0;
+		m_pending = false;
+	}
+
+private:
+	static constexpr uint8_t RECORD_COUNT = 4;
+	static constexpr uint32_t ADDRESSES[RECORD_COUNT] = {0x0500, 0x0A00, 0x1000, 0x10F8};
+
+	Eeprom24* m_eeprom = nullptr;
+	std::unique_ptr<Eeprom24Journal> m_journal;
+	uint16_t m_targets[4];
+
+	uint32_t m_values[RECORD_COUNT] = {0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF};
+	uint32_t m_transaction = 0;			///< last one started; odd ones write records 2 and 3, even ones 0 and 1
+	bool m_pending = false;
+};
+
+constexpr uint32_t JournalPairsScenario::ADDRESSES[];
+
+
+/** Two blobs replaced with new versions of varying size. A blob must read back complete, as the last closed version
+ *  or the one being written; a blob that disappears counts as a failure too.
+ */
+class BlobScenario: public Scenario
+{
+public:
+	using Scenario::Scenario;
+
+	const char* getName(void) const override {return "blob";};
+	uint32_t getWindow(void) const override {return 4 * 128;};
+
+	void attach(Eeprom24& eeprom) override
+	{
+		m_store.reset(new Store(eeprom, 0x4000));
+	}
+
+	bool mount(void) override
+	{
+		if (!m_formatted)
+		{
+			if (!m_store->format())
+				return false;
+			m_formatted = true;
+		}
+		return m_store->mount();
+	}
+
+	bool check(void) override
+	{
+		uint16_t used = 0;
+		for (uint8_t id = 0; id < BLOB_COUNT; id++)
+		{
+			if (!m_store->exists(id))
+			{
+				if (m_closed[id] != 0)
+					return fail("blob %u lost (version %u)", id, m_closed[id]);
+				continue;
+			}
+
+			uint32_t version;
+			if (!readBlob(id, &version))
+				return false;
+			if (version != m_closed[id] && !(m_writing == id && version == m_next))
+				return fail("blob %u at version %u, closed %u", id, version, m_closed[id]);
+
+			m_closed[id] = version;
+			used += (getSize(version) + m_store->getPayloadSize() - 1) / m_store->getPayloadSize();
+		}
+
+		if (m_store->getFreePages() != PAGE_COUNT - 1 - used)
+			return fail("%u free pages, expected %u", m_store->getFreePages(), PAGE_COUNT - 1 - used);
+
+		m_writing = NONE;
+		return true;
+	}
+
+	void step(void) override
+	{
+		uint8_t id = m_sim.random() % BLOB_COUNT;
+		uint32_t version = ++m_next;
+		uint32_t size = getSize(version);
+		uint8_t data[size];
+		fill(data, size, version);
+
+		m_writing = id;
+		Eeprom24BlobStore::Writer writer(*m_store);
+		if (writer.open(id) && writer.write(data, size) && writer.close())
+		{
+			m_closed[id] = version;
+			m_writing = NONE;
+		}
+	}
+
+	void reset(void) override
+	{
+		erase(0x4000, PAGE_COUNT * 128);
+		m_formatted = false;
+		memset(m_closed, 0, sizeof(m_closed));
+		m_writing = NONE;
+	}
+
+private:
+	typedef Eeprom24BlobStoreBuffer<64, 4> Store;
+	static constexpr uint16_t PAGE_COUNT = 64;
+	static constexpr uint8_t BLOB_COUNT = 2;
+	static constexpr uint8_t NONE = 0xFF;
+
+	static uint32_t getSize(uint32_t version) {return 40 + (version * 97) % 500;};
+
+	static void fill(uint8_t* data, uint32_t size, uint32_t version)
+	{
+		memcpy(data, &version, sizeof(version));
+		for (uint32_t i = sizeof(version); i < size; i++)
+			data[i] = version * 31 + i;
+	}
+
+	bool readBlob(uint8_t id, uint32_t* version)
+	{
+		Eeprom24BlobStore::Reader reader(*m_store);
+		uint8_t data[600], expected[600];
+		if (!reader.open(id) || reader.getSize() < sizeof(uint32_t) || reader.getSize() > sizeof(data))
+			return fail("blob %u can't be opened (size %u)", id, m_store->getSize(id));
+
+		uint32_t size = reader.getSize();
+		if (reader.read(data, size) != size)
+			return fail("blob %u short read", id);
+
+		memcpy(version, data, sizeof(uint32_t));
+		if (size != getSize(*version))
+			return fail("blob %u version %u has size %u", id, *version, size);
+
+		fill(expected, size, *version);
+		if (memcmp(data, expected, size) != 0)
+			return fail("blob %u version %u corrupted", id, *version);
+		return true;
+	}
+
+	std::unique_ptr<Store> m_store;
+	bool m_formatted = false;
+	uint32_t m_closed[BLOB_COUNT] = {};
+	uint32_t m_next = 0;
+	uint8_t m_writing = NONE;
+};
+
+
+/** A regular signal appended to a time series and flushed every few samples. Everything flushed must be recovered,
+ *  and every recovered sample must be one that was appended, in order.
+ */
+class TimeSeriesScenario: public Scenario
+{
+public:
+	using Scenario::Scenario;
+
+	const char* getName(void) const override {return "timeseries";};
+	uint32_t getWindow(void) const override {return 8 * 128;};
+
+	void attach(Eeprom24& eeprom) override
+	{
+		m_series.reset(new Eeprom24TimeSeries(eeprom, 0x8000, BLOCK_COUNT));
+	}
+
+	bool mount(void) override
+	{
+		return m_series->mount();
+	}
+
+	bool check(void) override
+	{
+		static Eeprom24TimeSeries::Sample samples[BLOCK_COUNT * 1024];
+		uint32_t count = m_series->query(0, 0xFFFFFFFF, samples, sizeof(samples) / sizeof(samples[0]));
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (samples[i].value != getValue(samples[i].timestamp))
+				return fail("sample %u: value %g at t=%u", i, samples[i].value, samples[i].timestamp);
+			if (i > 0 && samples[i].timestamp != samples[i - 1].timestamp + 1)
+				return fail("sample %u: t=%u after t=%u", i, samples[i].timestamp, samples[i - 1].timestamp);
+			if (samples[i].timestamp >= m_next)
+				return fail("sample %u: t=%u never appended", i, samples[i].timestamp);
+		}
+
+		uint32_t last = count ? samples[count - 1].timestamp + 1 : 0;
+		if (last < m_durable)
+			return fail("flushed up to t=%u, recovered up to t=%u", m_durable - 1, (int)last - 1);
+
+		//samples lost with the RAM are appended again
+		m_next = last;
+		m_durable = last;
+		return true;
+	}
+
+	void step(void) override
+	{
+		for (uint8_t i = 0; i < FLUSH_INTERVAL; i++)
+		{
+			if (!m_series->append(m_next, getValue(m_next)))
+				return;
+			m_next++;
+		}
+
+		if (m_series->flush())
+			m_durable = m_next;
+	}
+
+	void reset(void) override
+	{
+		erase(0x8000, BLOCK_COUNT * 128);
+		m_next = 0;
+		m_durable = 0;
+	}
+
+private:
+	static constexpr uint16_t BLOCK_COUNT = 64;
+	static constexpr uint8_t FLUSH_INTERVAL = 10;
+
+	static float getValue(uint32_t timestamp) {return (timestamp % 1000) * 0.25f;};
+
+	std::unique_ptr<Eeprom24TimeSeries> m_series;
+	uint32_t m_next = 0;
+	uint32_t m_durable = 0;
+};
+
+
+/** A record migrated over two schema versions, with a field transformed in place in both steps, one moved and resized
+ *  and one moved into the space the other left. Every step starts over from the oldest version; once mounted, the
+ *  record must hold the values of the newest version, with each transform applied exactly once.
+ */
+class SchemaScenario: public Scenario
+{
+public:
+	using Scenario::Scenario;
+
+	const char* getName(void) const override {return "schema";};
+	uint32_t getWindow(void) const override {return 96;};
+
+	void attach(Eeprom24& eeprom) override
+	{
+		m_eeprom = &eeprom;
+		m_schema.reset(new Eeprom24Schema(eeprom, ADDRESS, VERSIONS, 3));
+	}
+
+	bool mount(void) override
+	{
+		if (!m_written)
+			reset();
+
+		Eeprom24Schema::Result result = m_schema->mount();
+		return result == Eeprom24Schema::SCHEMA_CURRENT || result == Eeprom24Schema::SCHEMA_MIGRATED;
+	}
+
+	bool check(void) override
+	{
+		if (m_schema->getStoredVersion() != 3)
+			return fail("stored version %u", m_schema->getStoredVersion());
+
+		V3 stored;
+		if (!m_eeprom->read(m_schema->getDataAddress(), reinterpret_cast<uint8_t*>(&stored), sizeof(stored)))
+			return fail("read failed");
+
+		if (stored.counter != COUNTER + 1000 + 1)
+			return fail("counter %u, expected %u", stored.counter, COUNTER + 1000 + 1);
+		if (stored.scale != SCALE)
+			return fail("scale %u, expected %u", stored.scale, SCALE);
+		if (memcmp(stored.name, NAME, sizeof(stored.name)) != 0)
+			return fail("name \"%.8s\"", stored.name);
+		if (stored.flags != FLAGS)
+			return fail("flags %08X", stored.flags);
+		return true;
+	}
+
+	void step(void) override
+	{
+		reset();
+		m_schema->mount();
+	}
+
+	/** Puts the oldest version in place, behind the device's back. */
+	void reset(void) override
+	{
+		V1 record {};
+		record.counter = COUNTER;
+		record.scale = SCALE;
+		memcpy(record.name, NAME, sizeof(record.name));
+		uint8_t header[Eeprom24Schema::HEADER_SIZE] = {0x24, 0x5E, 1, 0};
+
+		erase(ADDRESS, 128);
+		memcpy(m_sim.getMemory() + ADDRESS, header, sizeof(header));
+		memcpy(m_sim.getMemory() + ADDRESS + sizeof(header), &record, sizeof(record));
+		m_written = true;
+	}
+
+private:
+	struct V1
+	{
+		uint32_t counter;
+		uint16_t scale;
+		uint8_t pad[2];
+		char name[8];
+	};
+
+	struct V2
+	{
+		uint32_t counter;
+		char name[8];
+		uint32_t scale;
+		uint32_t flags;
+	};
+
+	typedef V2 V3;
+
+	static constexpr uint32_t ADDRESS = 0xC000;
+	static constexpr uint32_t COUNTER = 5;
+	static constexpr uint16_t SCALE = 300;
+	static constexpr uint32_t FLAGS = 0xA5A5;
+	static constexpr char NAME[8] = {'s', 'e', 'n', 's', 'o', 'r', '-', '1'};
+
+	static void addThousand(const uint8_t* old, uint16_t oldSize, uint8_t* value, uint16_t size)
+	{
+		(void)oldSize;
+		uint32_t counter;
+		memcpy(&counter, old, sizeof(counter));
+		counter += 1000;
+		memcpy(value, &counter, size);
+	}
+
+	static void addOne(const uint8_t* old, uint16_t oldSize, uint8_t* value, uint16_t size)
+	{
+		(void)oldSize;
+		uint32_t counter;
+		memcpy(&counter, old, sizeof(counter));
+		counter += 1;
+		memcpy(value, &counter, size);
+	}
+
+	static const Eeprom24Field V1_FIELDS[];
+	static const Eeprom24Field V2_FIELDS[];
+	static const Eeprom24Field V3_FIELDS[];
+	static const Eeprom24SchemaVersion VERSIONS[];
+
+	Eeprom24* m_eeprom = nullptr;
+	std::unique_ptr<Eeprom24Schema> m_schema;
+	bool m_written = false;
+};
+
+constexpr char SchemaScenario::NAME[];
+static const uint32_t s_flags = 0xA5A5;
+
+const Eeprom24Field SchemaScenario::V1_FIELDS[] = {
+	EEPROM24_FIELD(V1, counter, 1),
+	EEPROM24_FIELD(V1, scale, 2),
+	EEPROM24_FIELD(V1, name, 3),
+};
+
+const Eeprom24Field SchemaScenario::V2_FIELDS[] = {
+	EEPROM24_FIELD_TRANSFORM(V2, counter, 1, addThousand),
+	EEPROM24_FIELD(V2, name, 3),
+	EEPROM24_FIELD(V2, scale, 2),
+	EEPROM24_FIELD_DEFAULT(V2, flags, 4, &s_flags),
+};
+
+const Eeprom24Field SchemaScenario::V3_FIELDS[] = {
+	EEPROM24_FIELD_TRANSFORM(V3, counter, 1, addOne),
+	EEPROM24_FIELD(V3, name, 3),
+	EEPROM24_FIELD(V3, scale, 2),
+	EEPROM24_FIELD(V3, flags, 4),
+};
+
+const Eeprom24SchemaVersion SchemaScenario::VERSIONS[] = {
+	EEPROM24_SCHEMA_VERSION(1, V1, SchemaScenario::V1_FIELDS),
+	EEPROM24_SCHEMA_VERSION(2, V2, SchemaScenario::V2_FIELDS),
+	EEPROM24_SCHEMA_VERSION(3, V3, SchemaScenario::V3_FIELDS),
+};
+
+
+struct Stats
+{
+	uint32_t iterations = 0;
+	uint32_t workloadCuts = 0;
+	uint32_t recoveryCuts = 0;
+	uint32_t mountErrors = 0;
+	uint32_t violations = 0;
+	uint64_t steps = 0;
+	std::vector<uint32_t> recovery;
+
+	//a recovery spans the power-ups until a mount completes; the time the device spends unpowered doesn't count
+	uint64_t recoveryTime = 0;
+};
+
+
+/** One power-up: recovery, invariant check, workload until the next cut.
+ *
+ */
+static void iterate(Eeprom24Sim& sim, Scenario& scenario, Stats& stats)
+{
+	Eeprom24_512 eeprom(sim.getHandle());
+	scenario.attach(eeprom);
+	Eeprom24Sim::CutMode mode = (sim.random() & 1) ? Eeprom24Sim::CUT_TORN : Eeprom24Sim::CUT_UNDEFINED;
+	stats.iterations++;
+
+	//one in four recoveries is interrupted as well
+	if (sim.random() % 4 == 0)
+		sim.armPowerCut(sim.random() % scenario.getWindow(), mode);
+
+	uint64_t start = Eeprom24Sim::now();
+	bool mounted = scenario.mount();
+	sim.disarmPowerCut();
+
+	if (!sim.isPowered())
+	{
+		stats.recoveryTime += sim.getCutTime() - start;
+		stats.recoveryCuts++;
+		return;
+	}
+
+	stats.recovery.push_back(stats.recoveryTime + Eeprom24Sim::now() - start);
+	stats.recoveryTime = 0;
+	if (!mounted)
+		stats.mountErrors++;
+
+	if (!scenario.check())
+	{
+		if (stats.violations++ < 10)
+			printf("iteration %u, cut at 0x%04X: %s\n", stats.iterations, sim.getCutAddress(), scenario.getError());
+		scenario.reset();
+		return;
+	}
+
+	sim.armPowerCut(sim.random() % scenario.getWindow(), mode);
+	for (uint32_t i = 0; i < 10000 && sim.isPowered(); i++)
+	{
+		scenario.step();
+		stats.steps++;
+	}
+
+	if (!sim.isPowered())
+		stats.workloadCuts++;
+	sim.disarmPowerCut();
+}
+
+
+static void report(const Scenario& scenario, Stats& stats, double hostSeconds)
+{
+	std::vector<uint32_t>& times = stats.recovery;
+	std::sort(times.begin(), times.end());
+
+	printf("store                %s\n", scenario.getName());
+	printf("iterations           %u (%.0f/s)\n", stats.iterations, hostSeconds > 0 ? stats.iterations / hostSeconds : 0.0);
+	printf("workload steps       %llu\n", (unsigned long long)stats.steps);
+	printf("power cuts           %u in workload, %u in recovery\n", stats.workloadCuts, stats.recoveryCuts);
+	printf("mount errors         %u\n", stats.mountErrors);
+	printf("invariant failures   %u\n", stats.violations);
+
+	if (times.empty())
+		return;
+
+	auto percentile = [&times](double p) {return times[(size_t)(p * (times.size() - 1))];};
+	printf("recovery time [us]   min %u, median %u, p99 %u, max %u\n", times.front(), percentile(0.5), percentile(0.99), times.back());
+
+	//power of two buckets
+	uint32_t buckets[33] = {};
+	for (uint32_t t : times)
+		buckets[t ? 32 - __builtin_clz(t) : 0]++;
+
+	for (uint8_t b = 0; b < 33; b++)
+	{
+		if (buckets[b] == 0)
+			continue;
+		printf("  < %8lu us  %8u  ", 1UL << b, buckets[b]);
+		for (uint32_t i = 0; i < 50 * buckets[b] / times.size(); i++)
+			putchar('#');
+		putchar('\n');
+	}
+}
+
+
+static Scenario* createScenario(const char* name, Eeprom24Sim& sim)
+{
+	if (strcmp(name, "journal") == 0)
+		return new JournalScenario(sim);
+	if (strcmp(name, "journal-pairs") == 0)
+		return new JournalPairsScenario(sim);
+	if (strcmp(name, "blob") == 0)
+		return new BlobScenario(sim);
+	if (strcmp(name, "timeseries") == 0)
+		return new TimeSeriesScenario(sim);
+	if (strcmp(name, "schema") == 0)
+		return new SchemaScenario(sim);
+	return nullptr;
+}
+
+
+/** Runs one store from blank memory.
+ *
+ * @return				Number of invariant failures.
+ */
+static uint32_t run(Eeprom24Sim& sim, Scenario& scenario, uint32_t iterations, uint32_t seed)
+{
+	memset(sim.getMemory(), 0xFF, sim.getSize());
+	sim.setSeed(seed);
+
+	Stats stats;
+	auto start = std::chrono::steady_clock::now();
+
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		sim.powerCycle();
+		iterate(sim, scenario, stats);
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	report(scenario, stats, elapsed.count());
+	return stats.violations;
+}
+
+
+int main(int argc, char** argv)
+{
+	static const char* const stores[] = {"journal", "journal-pairs", "blob", "timeseries", "schema"};
+
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s <journal|journal-pairs|blob|timeseries|schema|all> [iterations] [seed]\n", argv[0]);
+		return 1;
+	}
+
+	static Eeprom24Sim sim(65536, 128, 2);
+	uint32_t iterations = (argc > 2) ? strtoul(argv[2], nullptr, 0) : 10000;
+	uint32_t seed = (argc > 3) ? strtoul(argv[3], nullptr, 0) : 1;
+	bool all = (strcmp(argv[1], "all") == 0);
+	uint32_t violations = 0;
+	bool found = false;
+
+	for (const char* store : stores)
+	{
+		if (!all && strcmp(argv[1], store) != 0)
+			continue;
+
+		std::unique_ptr<Scenario> scenario(createScenario(store, sim));
+		if (found)
+			printf("\n");
+		violations += run(sim, *scenario, iterations, seed);
+		found = true;
+	}
+
+	if (!found)
+	{
+		fprintf(stderr, "unknown store %s\n", argv[1]);
+		return 1;
+	}
+
+	return violations ? 2 : 0;
+}